@@ -14,6 +14,11 @@ typedef struct RDBasicBlock {
 
 // clang-format off
 REDASM_EXPORT RDFunction* rd_findfunction(RDAddress address);
+REDASM_EXPORT usize rd_getcallers(RDAddress address, const RDAddress** callers);
+REDASM_EXPORT usize rd_getcallees(RDAddress address, const RDAddress** callees);
+REDASM_EXPORT usize rd_getcallclosure(RDAddress address, bool callers, const RDAddress** functions);
+REDASM_EXPORT bool rd_iscallreachable(RDAddress fromaddr, RDAddress toaddr);
+REDASM_EXPORT bool rd_buildcallgraph(RDGraph* g, RDAddress address, usize depth);
 REDASM_EXPORT RDAddress rdfunction_getentry(const RDFunction* self);
 REDASM_EXPORT RDGraph* rdfunction_getgraph(RDFunction* self);
 REDASM_EXPORT RDThemeKind rdfunction_gettheme(const RDFunction* self, const RDGraphEdge* edge);
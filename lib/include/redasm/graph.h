@@ -119,6 +119,36 @@ typedef enum RDLayeredLayoutType {
 
 REDASM_EXPORT bool rdgraphlayout_layered(RDGraph* self, usize type);
 
+typedef enum RDGraphPattern {
+    GRAPHPATTERN_NESTED = 0, // 'n' nested if/else levels
+    GRAPHPATTERN_SWITCH,     // 'n'-way switch with fall-through cases
+    GRAPHPATTERN_IRREDUCIBLE, // 'n' loops with two entry blocks
+} RDGraphPattern;
+
+// Synthetic CFGs for layout benchmarks, replaces the graph's contents
+REDASM_EXPORT bool rdgraph_generate(RDGraph* self, usize pattern, usize n);
+
+typedef struct RDPreLayoutParams {
+    usize minblocks; // Smaller functions are skipped
+    usize type;      // RDLayeredLayoutType
+    float cellwidth, cellheight; // Node size is rows/columns * cell size
+} RDPreLayoutParams;
+
+typedef struct RDPreLayoutStatus {
+    usize done, total;
+    bool busy;
+} RDPreLayoutStatus;
+
+// Lays out function graphs in background and stores them in the layout cache,
+// graphs are measured by rd_stepprelayout() on the UI thread
+REDASM_EXPORT bool rd_prelayout(const RDPreLayoutParams* params);
+
+// Measures the next graphs within a few milliseconds, returns false when
+// there's nothing left to measure
+REDASM_EXPORT bool rd_stepprelayout(void);
+REDASM_EXPORT bool rd_getprelayoutstatus(RDPreLayoutStatus* s);
+REDASM_EXPORT void rd_cancelprelayout(void);
+
 #ifdef __cplusplus
 #include <functional>
 
@@ -127,7 +157,8 @@ namespace std {
 template<>
 struct hash<RDGraphEdge> {
     size_t operator()(const RDGraphEdge& edge) const {
-        return edge.src ^ edge.dst;
+        // 'src ^ dst' collides for (a, b)/(b, a) and for small node ids
+        return (edge.src * 0x9e3779b97f4a7c15ull) ^ edge.dst;
     }
 };
 
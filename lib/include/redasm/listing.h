@@ -4,14 +4,40 @@
 #include <redasm/theme.h>
 #include <redasm/types.h>
 
+RD_HANDLE(RDSymbolTable);
+
 typedef enum RDSymbolKind {
     SYMBOL_INVALID = 0,
     SYMBOL_SEGMENT,
     SYMBOL_FUNCTION,
     SYMBOL_STRING,
     SYMBOL_TYPE,
+    SYMBOL_COMMENT,
 } RDSymbolKind;
 
+typedef enum RDSearchFlags {
+    SEARCH_NAMES = 1 << 0,
+    SEARCH_COMMENTS = 1 << 1,
+    SEARCH_STRINGS = 1 << 2,
+    SEARCH_PREFIX = 1 << 3, // Match from the beginning only
+
+    SEARCH_ALL = SEARCH_NAMES | SEARCH_COMMENTS | SEARCH_STRINGS,
+} RDSearchFlags;
+
+typedef enum RDSymbolTableKind {
+    SYMBOLTABLE_SYMBOLS = 0,
+    SYMBOLTABLE_IMPORTS,
+    SYMBOLTABLE_EXPORTS,
+
+    SYMBOLTABLE_COUNT,
+} RDSymbolTableKind;
+
+typedef enum RDSymbolColumn {
+    SYMBOLCOLUMN_ADDRESS = 0,
+    SYMBOLCOLUMN_TYPE,
+    SYMBOLCOLUMN_VALUE,
+} RDSymbolColumn;
+
 typedef enum RDListingItemType {
     LISTINGITEM_EMPTY = 0,
     LISTINGITEM_HEX_DUMP,
@@ -30,7 +56,13 @@ typedef struct RDSymbol {
     const char* value;
 } RDSymbol;
 
+// Return 'false' to stop the enumeration
+typedef bool (*RDSearchCallback)(const RDSymbol* symbol, usize rank,
+                                 void* userdata);
+
 REDASM_EXPORT bool rdlisting_getindex(RDAddress address, LIndex* idx);
+REDASM_EXPORT bool rdlisting_getcontainingindex(RDAddress address,
+                                                LIndex* idx);
 REDASM_EXPORT bool rdlisting_getsymbol(usize idx, RDSymbol* symbol);
 REDASM_EXPORT usize rdlisting_getsymbolslength();
 REDASM_EXPORT bool rdlisting_getimport(usize idx, RDSymbol* symbol);
@@ -38,3 +70,23 @@ REDASM_EXPORT usize rdlisting_getimportslength();
 REDASM_EXPORT bool rdlisting_getexport(usize idx, RDSymbol* symbol);
 REDASM_EXPORT usize rdlisting_getexportslength();
 REDASM_EXPORT usize rdlisting_getlength();
+
+// Snapshots are immutable: sort and filter can run outside the UI thread
+REDASM_EXPORT RDSymbolTable* rdsymboltable_create(usize kind);
+REDASM_EXPORT void rdsymboltable_destroy(RDSymbolTable* self);
+REDASM_EXPORT bool rdsymboltable_isvalid(const RDSymbolTable* self);
+REDASM_EXPORT usize rdsymboltable_getlength(const RDSymbolTable* self);
+REDASM_EXPORT bool rdsymboltable_get(const RDSymbolTable* self, usize idx,
+                                     RDSymbol* symbol);
+REDASM_EXPORT void rdsymboltable_sort(RDSymbolTable* self, usize column,
+                                      bool descending);
+
+// Uses the search index: matches are ranked until the table is sorted
+REDASM_EXPORT void rdsymboltable_filter(RDSymbolTable* self,
+                                        const char* query);
+
+REDASM_EXPORT usize rd_searchsymbols(const char* query, usize flags,
+                                     RDSearchCallback cb, void* userdata);
+REDASM_EXPORT usize rd_searchsymbols_ex(const char* query, usize flags,
+                                        usize offset, RDSearchCallback cb,
+                                        void* userdata);
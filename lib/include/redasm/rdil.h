@@ -156,6 +156,9 @@ REDASM_EXPORT void rdilist_destroy(RDILList* self);
 REDASM_EXPORT RDILPool* rdillist_getpool(RDILList* self);
 REDASM_EXPORT void rdil_generate(const RDFunction* f, RDILList* l);
 
+// Shared lifted form, valid until the next rdil_getfunction() call
+REDASM_EXPORT const RDILList* rdil_getfunction(const RDFunction* f);
+
 REDASM_EXPORT const RDILExpr* rdillist_at(const RDILList* self, usize idx);
 
 REDASM_EXPORT void rdillist_append(RDILList* self, const RDILExpr* e);
@@ -58,11 +58,35 @@ typedef enum RDSetType {
     ST_WEAK = (1 << 0),
 } RDSetType;
 
+typedef enum RDProblemCode {
+    PROBLEM_CUSTOM = 0,
+    PROBLEM_INVALID_FUNCTION,
+    PROBLEM_INVALID_ENTRY,
+    PROBLEM_INVALID_FROM_REF,
+    PROBLEM_INVALID_TO_REF,
+    PROBLEM_NONCODE_SEGMENT,
+    PROBLEM_OUTSIDE_SEGMENTS,
+    PROBLEM_NAME_OUT_OF_BOUNDS,
+    PROBLEM_NAME_ALREADY_SET,
+    PROBLEM_NAME_EXISTS,
+    PROBLEM_DELAY_SLOT,
+    PROBLEM_DECODE_NOT_IMPLEMENTED,
+
+    PROBLEM_COUNT,
+} RDProblemCode;
+
 typedef struct RDProblem {
     RDAddress address;
     const char* problem;
+    usize code;
 } RDProblem;
 
+typedef struct RDProblemCount {
+    usize code;
+    usize count;  // Occurrences, including duplicates and dropped ones
+    usize stored; // Stored problems (up to the limit)
+} RDProblemCount;
+
 define_slice(RDProblemSlice, RDProblem);
 
 typedef struct RDTestResult {
@@ -77,12 +101,36 @@ typedef void (*RDLogCallback)(const char*, void*);
 typedef void (*RDStatusCallback)(const char*, void*);
 typedef void (*RDErrorCallback)(const char*, void*);
 
+typedef enum RDInitFlags {
+    IF_ASYNCDB = 1 << 0,  // Apply database writes in a background thread
+    IF_MEMORYDB = 1 << 1, // Keep the database in memory (see rd_savedb())
+    IF_LAZYLISTING = 1 << 2, // Generate listing rows on demand
+} RDInitFlags;
+
+typedef enum RDSnapshotFlags {
+    SNAP_COMPRESS = 1 << 0, // Compress metadata and database chunks
+} RDSnapshotFlags;
+
+typedef enum RDExportFlags {
+    EXPORT_JSONL = 1 << 0, // One JSON object per row, with token themes
+    EXPORT_RDIL = 1 << 1,  // Render instructions as RDIL
+} RDExportFlags;
+
+typedef struct RDDatabaseMetrics {
+    usize pending;       // Queued writes not yet applied
+    usize highwatermark; // Max queued writes observed
+    usize batches;       // Committed transactions
+    u64 lastflushus;     // Last transaction latency (microseconds)
+    u64 maxflushus;      // Max transaction latency (microseconds)
+} RDDatabaseMetrics;
+
 typedef struct RDInitParams {
     RDLogCallback onlog;
     RDStatusCallback onstatus;
     RDErrorCallback onerror;
     RDUI ui;
     void* userdata;
+    usize flags;
 } RDInitParams;
 
 REDASM_EXPORT bool rd_init(const RDInitParams* params);
@@ -108,6 +156,14 @@ REDASM_EXPORT bool rd_tick(const RDWorkerStatus** s);
 
 REDASM_EXPORT void rd_addsearchpath(const char* path);
 REDASM_EXPORT const RDProblemSlice* rd_getproblems(void);
+REDASM_EXPORT usize rd_getproblemcounts(const RDProblemCount** counts);
+REDASM_EXPORT void rd_setproblemlimit(usize n);
+REDASM_EXPORT void rd_setmaxthreads(usize n); // 0 = hardware threads
+REDASM_EXPORT bool rd_getdbmetrics(RDDatabaseMetrics* m);
+REDASM_EXPORT bool rd_savedb(const char* filepath);
+REDASM_EXPORT bool rd_savesnapshot(const char* filepath, usize flags);
+REDASM_EXPORT bool rd_loadsnapshot(const char* filepath);
+REDASM_EXPORT bool rd_exportlisting(const char* filepath, usize flags);
 REDASM_EXPORT const RDTestResultSlice* rd_test(RDBuffer* file);
 REDASM_EXPORT void rd_disassemble(void);
 
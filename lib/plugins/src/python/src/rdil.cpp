@@ -132,8 +132,7 @@ PyObject* rdil_createfunction(PyRDIL* /*self*/, PyObject* args) {
     const RDFunction* f = rd_findfunction(address);
     if(!f) return Py_None;
 
-    RDILList* exprlist = rdilist_create();
-    rdil_generate(f, exprlist);
+    const RDILList* exprlist = rdil_getfunction(f);
     PyObject* res = PyTuple_New(rdillist_getsize(exprlist));
 
     for(usize i = 0; i < rdillist_getsize(exprlist); i++) {
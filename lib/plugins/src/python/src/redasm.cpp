@@ -145,11 +145,15 @@ PyObject* get_problems(PyObject* /*self*/, PyObject* /*args*/) {
             PyLong_FromUnsignedLongLong(slice_at(problems, i).address);
         PyObject* itemprob =
             PyUnicode_FromString(slice_at(problems, i).problem);
+        PyObject* itemcode =
+            PyLong_FromUnsignedLongLong(slice_at(problems, i).code);
         PyObject_SetAttrString(item, "address", itemaddr);
         PyObject_SetAttrString(item, "problem", itemprob);
+        PyObject_SetAttrString(item, "code", itemcode);
         PyTuple_SET_ITEM(res, i, item);
         Py_DECREF(itemaddr);
         Py_DECREF(itemprob);
+        Py_DECREF(itemcode);
     }
 
     return res;
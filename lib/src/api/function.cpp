@@ -3,7 +3,31 @@
 #include "../state.h"
 #include "marshal.h"
 #include <redasm/function.h>
+#include <bit>
 #include <spdlog/spdlog.h>
+#include <vector>
+
+namespace {
+
+usize get_calls(RDAddress address, bool callers, std::vector<RDAddress>& res,
+                const RDAddress** out) {
+    res.clear();
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx) return 0;
+
+    auto cg = ctx->get_call_graph();
+
+    cg->index_of(address).map([&](u32 f) {
+        for(u32 c : callers ? cg->callers(f) : cg->callees(f))
+            res.push_back(cg->entry(c));
+    });
+
+    if(out) *out = res.data();
+    return res.size();
+}
+
+} // namespace
 
 RDFunction* rd_findfunction(RDAddress address) {
     spdlog::trace("rd_findfunction({:x})", address);
@@ -11,6 +35,70 @@ RDFunction* rd_findfunction(RDAddress address) {
     return redasm::api::to_c(ctx->program.find_function(address));
 }
 
+usize rd_getcallers(RDAddress address, const RDAddress** callers) {
+    spdlog::trace("rd_getcallers({:x}, {})", address, fmt::ptr(callers));
+    static std::vector<RDAddress> res;
+    return get_calls(address, true, res, callers);
+}
+
+usize rd_getcallees(RDAddress address, const RDAddress** callees) {
+    spdlog::trace("rd_getcallees({:x}, {})", address, fmt::ptr(callees));
+    static std::vector<RDAddress> res;
+    return get_calls(address, false, res, callees);
+}
+
+usize rd_getcallclosure(RDAddress address, bool callers,
+                        const RDAddress** functions) {
+    spdlog::trace("rd_getcallclosure({:x}, {}, {})", address, callers,
+                  fmt::ptr(functions));
+
+    static std::vector<RDAddress> res;
+    res.clear();
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx) return 0;
+
+    auto cg = ctx->get_call_graph();
+
+    cg->index_of(address).map([&](u32 f) {
+        redasm::CallGraph::Bitset b = cg->closure(f, callers);
+
+        for(usize w = 0; w < b.size(); w++) {
+            for(u64 bits = b[w]; bits; bits &= bits - 1)
+                res.push_back(cg->entry(w * 64 + std::countr_zero(bits)));
+        }
+    });
+
+    if(functions) *functions = res.data();
+    return res.size();
+}
+
+bool rd_iscallreachable(RDAddress fromaddr, RDAddress toaddr) {
+    spdlog::trace("rd_iscallreachable({:x}, {:x})", fromaddr, toaddr);
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx) return false;
+
+    auto cg = ctx->get_call_graph();
+    auto from = cg->index_of(fromaddr), to = cg->index_of(toaddr);
+    return from && to && cg->reaches(*from, *to);
+}
+
+bool rd_buildcallgraph(RDGraph* g, RDAddress address, usize depth) {
+    spdlog::trace("rd_buildcallgraph({}, {:x}, {})", fmt::ptr(g), address,
+                  depth);
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx || !g) return false;
+
+    auto cg = ctx->get_call_graph();
+    auto f = cg->index_of(address);
+    if(!f) return false;
+
+    cg->export_graph(*f, depth, *redasm::api::from_c(g));
+    return true;
+}
+
 RDAddress rdfunction_getentry(const RDFunction* self) {
     spdlog::trace("rd_functiongetentry({})", fmt::ptr(self));
     return redasm::api::from_c(self)->address;
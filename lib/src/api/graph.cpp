@@ -1,5 +1,8 @@
+#include "../context.h"
+#include "../graph/generator.h"
 #include "../graph/layouts/layeredlayout.h"
 #include "../graph/styledgraph.h"
+#include "../state.h"
 #include "marshal.h"
 #include <redasm/graph.h>
 #include <spdlog/spdlog.h>
@@ -249,3 +252,40 @@ bool rdgraphlayout_layered(RDGraph* self, usize type) {
     redasm::LayeredLayout ll(redasm::api::from_c(self), type);
     return ll.execute();
 }
+
+bool rdgraph_generate(RDGraph* self, usize pattern, usize n) {
+    spdlog::trace("rdgraph_generate({}, {}, {})", fmt::ptr(self), pattern, n);
+    return redasm::graphgen::generate(*redasm::api::from_c(self), pattern, n);
+}
+
+bool rd_prelayout(const RDPreLayoutParams* params) {
+    spdlog::trace("rd_prelayout({})", fmt::ptr(params));
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx || !params) return false;
+    return ctx->prelayout.start(ctx, *params);
+}
+
+bool rd_stepprelayout(void) {
+    spdlog::trace("rd_stepprelayout()");
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx) return false;
+    return ctx->prelayout.step(ctx);
+}
+
+bool rd_getprelayoutstatus(RDPreLayoutStatus* s) {
+    spdlog::trace("rd_getprelayoutstatus({})", fmt::ptr(s));
+
+    const redasm::Context* ctx = redasm::state::context;
+    if(!ctx) return false;
+
+    RDPreLayoutStatus st = ctx->prelayout.status();
+    if(s) *s = st;
+    return st.busy;
+}
+
+void rd_cancelprelayout(void) {
+    spdlog::trace("rd_cancelprelayout()");
+    if(redasm::state::context) redasm::state::context->prelayout.cancel();
+}
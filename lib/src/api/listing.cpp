@@ -2,100 +2,33 @@
 #include "../context.h"
 #include "../memory/memory.h"
 #include "../state.h"
+#include "../symbolindex.h"
+#include "../symboltable.h"
+#include "marshal.h"
 #include <redasm/listing.h>
 
 namespace {
 
-void listingindex_tosymbol(LIndex lidx, RDSymbol* symbol, std::string& value) {
-    ct_assume(symbol);
-    const redasm::Context* ctx = redasm::state::context;
-    ct_assume(ctx);
-    const redasm::Listing& listing = ctx->listing;
-    const redasm::ListingItem& item = listing[lidx];
-
-    symbol->address = item.address;
-
-    switch(item.type) {
-        case LISTINGITEM_SEGMENT: {
-            const RDSegment* seg = ctx->program.find_segment(item.address);
-            ct_assume(seg);
-            symbol->type = SYMBOL_SEGMENT;
-            symbol->theme = THEME_SEGMENT;
-            symbol->value = seg->name;
-            break;
-        }
-
-        case LISTINGITEM_LABEL:
-        case LISTINGITEM_FUNCTION: {
-            value = ctx->get_name(item.address);
-            symbol->type = SYMBOL_FUNCTION;
-            symbol->theme = THEME_FUNCTION;
-            symbol->value = value.c_str();
-            break;
-        }
-
-        case LISTINGITEM_TYPE: {
-            const RDSegment* seg = ctx->program.find_segment(item.address);
-            ct_assume(seg);
-            tl::optional<std::string> s;
-            ct_assume(item.dtype);
-
-            if(item.dtype->def->kind == TK_PRIMITIVE) {
-                switch(item.dtype->def->t_primitive) {
-                    case T_STR: {
-                        s = redasm::memory::get_str(seg, item.address);
-                        ct_assume(s);
-                        s = s->substr(item.string_index, item.length);
-                        break;
-                    }
-
-                    case T_WSTR: {
-                        s = redasm::memory::get_wstr(seg, item.address);
-                        ct_assume(s);
-                        s = s->substr(item.string_index, item.length);
-                        break;
-                    }
-
-                    case T_CHAR: {
-                        usize len =
-                            redasm::memory::get_length(seg, item.address);
-                        ct_assume(len > 0);
-                        s = redasm::memory::get_str(seg, item.address, len);
-                        break;
-                    }
-
-                    case T_WCHAR: {
-                        usize len =
-                            redasm::memory::get_length(seg, item.address);
-                        ct_assume(len > 0);
-                        s = redasm::memory::get_wstr(seg, item.address, len);
-                        break;
-                    }
-
-                    default: break;
-                }
-            }
-
-            if(!s) {
-                value = ctx->get_name(item.address);
-
-                symbol->type = SYMBOL_TYPE;
-                symbol->theme = THEME_DEFAULT;
-                symbol->value = value.c_str();
-            }
-            else {
-                value = "\"" + *s + "\"";
-
-                symbol->type = SYMBOL_STRING;
-                symbol->theme = THEME_STRING;
-                symbol->value = value.c_str();
-            }
-
-            break;
-        }
-
-        default: ct_unreachable; break;
+bool get_symbol(usize kind, usize idx, RDSymbol* symbol) {
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx) return false;
+
+    std::shared_ptr<const redasm::SymbolTable> t =
+        ctx->get_symbol_table(kind);
+    if(idx >= t->size()) return false;
+
+    const redasm::SymbolTable::Entry& e = t->at(idx);
+
+    if(symbol) {
+        *symbol = {
+            .address = e.address,
+            .type = e.type,
+            .theme = e.theme,
+            .value = e.value,
+        };
     }
+
+    return true;
 }
 
 } // namespace
@@ -105,30 +38,32 @@ bool rdlisting_getindex(RDAddress address, LIndex* idx) {
 
     if(!redasm::state::context) return false;
 
-    auto it = redasm::state::context->listing.lower_bound(address);
-    if(it == redasm::state::context->listing.end()) return false;
+    const redasm::Listing& listing = redasm::state::context->listing;
+    LIndex lidx = listing.lower_bound(address);
+    if(lidx >= listing.size()) return false;
 
-    if(idx) *idx = std::distance(redasm::state::context->listing.cbegin(), it);
+    if(idx) *idx = lidx;
     return true;
 }
 
-bool rdlisting_getsymbol(usize idx, RDSymbol* symbol) {
-    spdlog::trace("rdlisting_getsymbol({}, {})", idx, fmt::ptr(symbol));
+bool rdlisting_getcontainingindex(RDAddress address, LIndex* idx) {
+    spdlog::trace("rdlisting_getcontainingindex({:x}, {})", address,
+                  fmt::ptr(idx));
 
-    static std::string value;
-    const redasm::Context* ctx = redasm::state::context;
-    if(!ctx) return false;
+    if(!redasm::state::context) return false;
 
-    const redasm::Listing& listing = ctx->listing;
-    const redasm::Listing::LIndexList& symbols = listing.symbols();
-    if(idx >= symbols.size()) return false;
+    auto lidx = redasm::state::context->listing.find_row(address);
+    if(!lidx) return false;
 
-    LIndex lidx = symbols[idx];
-    ct_assume(lidx < listing.size());
-    if(symbol) listingindex_tosymbol(lidx, symbol, value);
+    if(idx) *idx = *lidx;
     return true;
 }
 
+bool rdlisting_getsymbol(usize idx, RDSymbol* symbol) {
+    spdlog::trace("rdlisting_getsymbol({}, {})", idx, fmt::ptr(symbol));
+    return get_symbol(SYMBOLTABLE_SYMBOLS, idx, symbol);
+}
+
 usize rdlisting_getsymbolslength() {
     spdlog::trace("rdlisting_getsymbolslength()");
     return redasm::state::context
@@ -138,19 +73,7 @@ usize rdlisting_getsymbolslength() {
 
 bool rdlisting_getimport(usize idx, RDSymbol* symbol) {
     spdlog::trace("rdlisting_getsymbolslength({}, {})", idx, fmt::ptr(symbol));
-
-    static std::string value;
-    const redasm::Context* ctx = redasm::state::context;
-    if(!ctx) return false;
-
-    const redasm::Listing& listing = ctx->listing;
-    const redasm::Listing::LIndexList& imports = listing.imports();
-    if(idx >= imports.size()) return false;
-
-    usize listingidx = imports[idx];
-    ct_assume(listingidx < listing.size());
-    if(symbol) listingindex_tosymbol(listingidx, symbol, value);
-    return true;
+    return get_symbol(SYMBOLTABLE_IMPORTS, idx, symbol);
 }
 
 usize rdlisting_getimportslength() {
@@ -162,19 +85,7 @@ usize rdlisting_getimportslength() {
 
 bool rdlisting_getexport(usize idx, RDSymbol* symbol) {
     spdlog::trace("rdlisting_getexport({}, {})", idx, fmt::ptr(symbol));
-
-    static std::string value;
-    const redasm::Context* ctx = redasm::state::context;
-    if(!ctx) return false;
-
-    const redasm::Listing& listing = ctx->listing;
-    const redasm::Listing::LIndexList& exports = listing.exports();
-    if(idx >= exports.size()) return false;
-
-    usize listingidx = exports[idx];
-    ct_assume(listingidx < listing.size());
-    if(symbol) listingindex_tosymbol(listingidx, symbol, value);
-    return true;
+    return get_symbol(SYMBOLTABLE_EXPORTS, idx, symbol);
 }
 
 usize rdlisting_getexportslength() {
@@ -188,3 +99,97 @@ usize rdlisting_getlength() {
     spdlog::trace("rdlisting_getlength()");
     return redasm::state::context ? redasm::state::context->listing.size() : 0;
 }
+
+usize rd_searchsymbols(const char* query, usize flags, RDSearchCallback cb,
+                       void* userdata) {
+    return rd_searchsymbols_ex(query, flags, 0, cb, userdata);
+}
+
+usize rd_searchsymbols_ex(const char* query, usize flags, usize offset,
+                          RDSearchCallback cb, void* userdata) {
+    spdlog::trace("rd_searchsymbols_ex('{}', {}, {}, {}, {})", query, flags,
+                  offset, fmt::ptr(cb), userdata);
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx || !query) return 0;
+
+    const redasm::SymbolIndex::Results& results =
+        ctx->symbolindex.search(query, flags);
+
+    for(usize i = offset; cb && i < results.size(); i++) {
+        const redasm::SymbolIndex::Entry& e =
+            ctx->symbolindex.entry(results[i]);
+
+        RDSymbol symbol = {
+            .address = e.address,
+            .type = e.type,
+            .theme = e.theme,
+            .value = e.value.c_str(),
+        };
+
+        if(!cb(&symbol, results[i].rank, userdata)) break;
+    }
+
+    return results.size();
+}
+
+RDSymbolTable* rdsymboltable_create(usize kind) {
+    spdlog::trace("rdsymboltable_create({})", kind);
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx || kind >= SYMBOLTABLE_COUNT) return nullptr;
+
+    return redasm::api::to_c(
+        new redasm::SymbolView(ctx->get_symbol_table(kind)));
+}
+
+void rdsymboltable_destroy(RDSymbolTable* self) {
+    spdlog::trace("rdsymboltable_destroy({})", fmt::ptr(self));
+    delete redasm::api::from_c(self);
+}
+
+bool rdsymboltable_isvalid(const RDSymbolTable* self) {
+    spdlog::trace("rdsymboltable_isvalid({})", fmt::ptr(self));
+    return self && redasm::api::from_c(self)->is_valid();
+}
+
+usize rdsymboltable_getlength(const RDSymbolTable* self) {
+    spdlog::trace("rdsymboltable_getlength({})", fmt::ptr(self));
+    return self ? redasm::api::from_c(self)->size() : 0;
+}
+
+bool rdsymboltable_get(const RDSymbolTable* self, usize idx,
+                       RDSymbol* symbol) {
+    spdlog::trace("rdsymboltable_get({}, {}, {})", fmt::ptr(self), idx,
+                  fmt::ptr(symbol));
+
+    if(!self) return false;
+
+    const redasm::SymbolTable::Entry* e = redasm::api::from_c(self)->at(idx);
+    if(!e) return false;
+
+    if(symbol) {
+        *symbol = {
+            .address = e->address,
+            .type = e->type,
+            .theme = e->theme,
+            .value = e->value,
+        };
+    }
+
+    return true;
+}
+
+void rdsymboltable_sort(RDSymbolTable* self, usize column, bool descending) {
+    spdlog::trace("rdsymboltable_sort({}, {}, {})", fmt::ptr(self), column,
+                  descending);
+
+    if(self) redasm::api::from_c(self)->sort(column, descending);
+}
+
+void rdsymboltable_filter(RDSymbolTable* self, const char* query) {
+    spdlog::trace("rdsymboltable_filter({}, '{}')", fmt::ptr(self),
+                  query ? query : "");
+
+    if(self) redasm::api::from_c(self)->filter(query ? query : "");
+}
@@ -22,6 +22,7 @@ struct SignatureManager;
 class Renderer;
 class Emulator;
 class Surface;
+class SymbolView;
 class Context;
 class StyledGraph;
 struct Function;
@@ -84,6 +85,14 @@ static inline Surface* from_c(RDSurface* arg) {
     return reinterpret_cast<Surface*>(arg);
 }
 
+static inline const SymbolView* from_c(const RDSymbolTable* arg) {
+    return reinterpret_cast<const SymbolView*>(arg);
+}
+
+static inline SymbolView* from_c(RDSymbolTable* arg) {
+    return reinterpret_cast<SymbolView*>(arg);
+}
+
 static inline RDContext* to_c(Context* arg) {
     return reinterpret_cast<RDContext*>(arg);
 }
@@ -116,6 +125,10 @@ static inline RDSurface* to_c(Surface* arg) {
     return reinterpret_cast<RDSurface*>(arg);
 }
 
+static inline RDSymbolTable* to_c(SymbolView* arg) {
+    return reinterpret_cast<RDSymbolTable*>(arg);
+}
+
 static inline RDFunction* to_c(Function* arg) {
     return reinterpret_cast<RDFunction*>(arg);
 }
@@ -132,6 +145,10 @@ static inline RDILList* to_c(rdil::ILExprList* arg) {
     return reinterpret_cast<RDILList*>(arg);
 }
 
+static inline const RDILList* to_c(const rdil::ILExprList* arg) {
+    return reinterpret_cast<const RDILList*>(arg);
+}
+
 static inline RDRegValue to_c(const tl::optional<u64>& arg) {
     if(!arg) return RDRegValue_none();
     return RDRegValue_some(arg.value());
@@ -1,6 +1,8 @@
+#include "../context.h"
 #include "../rdil/rdil.h"
 #include "../rdil/expression.h"
 #include "../rdil/expressionlist.h"
+#include "../state.h"
 #include "marshal.h"
 #include <redasm/rdil.h>
 #include <spdlog/spdlog.h>
@@ -213,6 +215,18 @@ void rdil_generate(const RDFunction* f, RDILList* l) {
     }
 }
 
+const RDILList* rdil_getfunction(const RDFunction* f) {
+    spdlog::trace("rdil_getfunction({})", fmt::ptr(f));
+    static std::shared_ptr<const redasm::rdil::ILFunction> il;
+    il.reset();
+
+    redasm::Context* ctx = redasm::state::context;
+    if(!ctx || !f) return nullptr;
+
+    il = ctx->rdilcache.get(*redasm::api::from_c(f));
+    return redasm::api::to_c(&il->expressions());
+}
+
 const RDILExpr* rdillist_at(const RDILList* self, usize idx) {
     spdlog::trace("rdillist_at({}, {})", fmt::ptr(self), idx);
     return redasm::api::from_c(self)->at(idx);
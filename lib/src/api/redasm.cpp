@@ -1,9 +1,12 @@
 #include "../context.h"
+#include "../database/snapshot.h"
 #include "../memory/memory.h"
 #include "../plugins/modulemanager.h"
 #include "../plugins/pluginmanager.h"
 #include "../state.h"
+#include "../surface/listingexport.h"
 #include "../surface/surface.h"
+#include "../utils/parallel.h"
 #include "../utils/utils.h"
 #include "marshal.h"
 #include <algorithm>
@@ -34,6 +37,7 @@ bool rd_init(const RDInitParams* params) {
         if(params->onerror) redasm::state::params.onerror = params->onerror;
         redasm::state::params.ui = params->ui,
         redasm::state::params.userdata = params->userdata;
+        redasm::state::params.flags = params->flags;
     }
 
     redasm::pm::create();
@@ -123,10 +127,61 @@ usize rd_getrefstotype(RDAddress toaddr, usize type, const RDRef** refs) {
 const RDProblemSlice* rd_getproblems() {
     spdlog::trace("rd_getproblems()");
     const redasm::Context* ctx = redasm::state::context;
-    if(ctx) return &ctx->problems;
+    if(ctx) return ctx->problems.get_problems();
     return nullptr;
 }
 
+usize rd_getproblemcounts(const RDProblemCount** counts) {
+    spdlog::trace("rd_getproblemcounts({})", fmt::ptr(counts));
+    const redasm::Context* ctx = redasm::state::context;
+    if(ctx) return ctx->problems.get_counts(counts);
+    return 0;
+}
+
+void rd_setproblemlimit(usize n) {
+    spdlog::trace("rd_setproblemlimit({})", n);
+    if(redasm::state::context) redasm::state::context->problems.set_limit(n);
+}
+
+void rd_setmaxthreads(usize n) {
+    spdlog::trace("rd_setmaxthreads({})", n);
+    redasm::utils::max_threads = n;
+}
+
+bool rd_getdbmetrics(RDDatabaseMetrics* m) {
+    spdlog::trace("rd_getdbmetrics({})", fmt::ptr(m));
+    const redasm::Context* ctx = redasm::state::context;
+    if(!ctx || !m) return false;
+
+    auto dbm = ctx->get_db_metrics();
+    if(dbm) *m = *dbm;
+    return dbm.has_value();
+}
+
+bool rd_savedb(const char* filepath) {
+    spdlog::trace("rd_savedb('{}')", filepath);
+    if(!redasm::state::context || !filepath) return false;
+    return redasm::state::context->save_db(filepath);
+}
+
+bool rd_savesnapshot(const char* filepath, usize flags) {
+    spdlog::trace("rd_savesnapshot('{}', {})", filepath, flags);
+    if(!redasm::state::context || !filepath) return false;
+    return redasm::snapshot::save(filepath, flags);
+}
+
+bool rd_loadsnapshot(const char* filepath) {
+    spdlog::trace("rd_loadsnapshot('{}')", filepath);
+    if(!redasm::state::context || !filepath) return false;
+    return redasm::snapshot::load(filepath);
+}
+
+bool rd_exportlisting(const char* filepath, usize flags) {
+    spdlog::trace("rd_exportlisting('{}', {})", filepath, flags);
+    if(!redasm::state::context || !filepath) return false;
+    return redasm::listingexport::save(filepath, flags);
+}
+
 const RDTestResultSlice* rd_test(RDBuffer* file) {
     spdlog::trace("rd_test({})", fmt::ptr(file));
 
@@ -395,20 +450,18 @@ const char* rd_rendertext(RDAddress address) {
     if(!redasm::state::context) return nullptr;
     static std::string s;
 
-    auto it = redasm::state::context->listing.lower_bound(address);
+    const redasm::Listing& listing = redasm::state::context->listing;
+    LIndex lidx = listing.lower_bound(address);
 
     // Find first code item
-    while(it != redasm::state::context->listing.end() &&
-          it->address == address) {
-        if(it->type == LISTINGITEM_INSTRUCTION) break;
-        it++;
+    while(lidx < listing.size() && listing.address_at(lidx) == address) {
+        if(listing.type_at(lidx) == LISTINGITEM_INSTRUCTION) break;
+        lidx++;
     }
 
-    if(it == redasm::state::context->listing.end() || it->address != address)
+    if(lidx >= listing.size() || listing.address_at(lidx) != address)
         return "";
 
-    LIndex lidx = std::distance(redasm::state::context->listing.cbegin(), it);
-
     redasm::Surface sf{SURFACE_TEXT};
     sf.seek(lidx);
     sf.render(1);
@@ -1,40 +1,77 @@
 #include "analyzer.h"
 #include "../context.h"
 #include "../plugins/pluginmanager.h"
-#include "../rdil/rdil.h"
+#include "../api/marshal.h"
 #include "../state.h"
 #include <limits>
 #include <redasm/analyzer.h>
+#include <spdlog/spdlog.h>
 
 namespace redasm::builtins {
 
 namespace {
 
+struct Stub {
+    enum Kind { NONE = 0, THUNK, NULLSUB };
+
+    Kind kind{NONE};
+    RDAddress target{};
+};
+
+Stub classify_stub(const RDILExpr* e) {
+    if(e->op == RDIL_GOTO) {
+        if(e->u->op == RDIL_MEM) e = e->u;
+
+        if(e->u->op == RDIL_VAR) return {Stub::THUNK, e->u->addr};
+        if(e->u->op == RDIL_CNST) return {Stub::THUNK, e->u->u_cnst};
+    }
+    else if(e->op == RDIL_NOP || e->op == RDIL_RET)
+        return {Stub::NULLSUB};
+
+    return {};
+}
+
 void do_autorename(RDAnalyzer*) {
     Context* ctx = state::context;
+    const RDProcessorPlugin* p = ctx->processorplugin;
+    ct_assume(p);
+
+    if(!p->decode || !p->lift) return;
 
+    std::vector<Context::NameRequest> names;
+    rdil::ILExprList el;
+
+    // Only the entry instruction is lifted, serially: processors decode
+    // into shared state
     for(const Function& f : ctx->program.functions) {
-        rdil::ILExprList el;
-        rdil::decode(f.address, el);
-        if(el.empty()) return;
+        el.reset();
+        el.currentaddress = f.address;
+
+        RDInstruction instr{};
 
-        const RDILExpr* e = el.first();
+        if(!ctx->worker->emulator.decode(f.address, instr) ||
+           !p->lift(ctx->processor, api::to_c(&el), &instr) || el.empty())
+            continue;
 
-        if(e->op == RDIL_GOTO) {
-            if(e->u->op == RDIL_MEM) e = e->u;
+        Stub stub = classify_stub(el.first());
 
-            std::string n;
+        switch(stub.kind) {
+            case Stub::THUNK: {
+                std::string n = ctx->get_name(stub.target, false);
+                if(!n.empty()) names.push_back({f.address, "_" + n, SN_NOWARN});
+                break;
+            }
 
-            if(e->u->op == RDIL_VAR)
-                n = ctx->get_name(e->u->addr, false);
-            else if(e->u->op == RDIL_CNST)
-                n = ctx->get_name(e->u->u_cnst, false);
+            case Stub::NULLSUB:
+                names.push_back({f.address, "nullsub", SN_ADDRESS});
+                break;
 
-            if(!n.empty()) ctx->set_name(f.address, "_" + n, SN_NOWARN);
+            default: break;
         }
-        else if(e->op == RDIL_NOP || e->op == RDIL_RET)
-            ctx->set_name(f.address, "nullsub", SN_ADDRESS);
     }
+
+    usize n = ctx->set_names(names);
+    spdlog::info("Autorename: {} functions renamed", n);
 }
 
 RDAnalyzerPlugin autorename_analyzer = {
@@ -0,0 +1,181 @@
+#include "callgraph.h"
+#include "context.h"
+#include "graph/styledgraph.h"
+#include "state.h"
+#include "utils/parallel.h"
+#include <algorithm>
+#include <bit>
+#include <spdlog/spdlog.h>
+
+namespace redasm {
+
+namespace {
+
+bool test_bit(const CallGraph::Bitset& b, u32 i) {
+    return b[i / 64] & (u64{1} << (i % 64));
+}
+
+void set_bit(CallGraph::Bitset& b, u32 i) { b[i / 64] |= u64{1} << (i % 64); }
+
+} // namespace
+
+CallGraph::CallGraph(usize generation): m_generation{generation} {
+    const Context* ctx = state::context;
+    ct_assume(ctx);
+
+    const std::vector<Function>& functions = ctx->program.functions;
+    m_entries.reserve(functions.size());
+
+    for(const Function& f : functions)
+        m_entries.push_back(f.address);
+
+    // One query for every call site, instead of one per function
+    Database::RangeRefList refs = ctx->get_refs_by_type(CR_CALL);
+    std::ranges::sort(refs, {}, &Database::RangeRef::fromaddr);
+
+    std::vector<std::vector<u32>> callees(functions.size());
+
+    utils::parallel_for(functions.size(), [&](usize i) {
+        std::vector<u32>& res = callees[i];
+
+        for(const Function::BasicBlock& bb : functions[i].blocks) {
+            auto it = std::ranges::lower_bound(
+                refs, bb.start, {}, &Database::RangeRef::fromaddr);
+
+            for(; it != refs.end() && it->fromaddr <= bb.end; it++) {
+                if(auto idx = this->index_of(it->toaddr); idx)
+                    res.push_back(*idx);
+            }
+        }
+
+        std::ranges::sort(res);
+        auto [first, last] = std::ranges::unique(res);
+        res.erase(first, last);
+    });
+
+    // Flatten callees, then transpose them into callers
+    m_callees.offsets.resize(functions.size() + 1);
+    m_callers.offsets.assign(functions.size() + 1, 0);
+
+    for(u32 i = 0; i < callees.size(); i++) {
+        m_callees.offsets[i + 1] = m_callees.offsets[i] + callees[i].size();
+        m_callees.targets.insert(m_callees.targets.end(), callees[i].begin(),
+                                 callees[i].end());
+
+        for(u32 c : callees[i])
+            m_callers.offsets[c + 1]++;
+    }
+
+    for(usize i = 0; i < functions.size(); i++)
+        m_callers.offsets[i + 1] += m_callers.offsets[i];
+
+    std::vector<u32> pos{m_callers.offsets.begin(),
+                         m_callers.offsets.end() - 1};
+    m_callers.targets.resize(m_callees.targets.size());
+
+    // Callers end up sorted, since callees are visited in index order
+    for(u32 i = 0; i < callees.size(); i++) {
+        for(u32 c : callees[i])
+            m_callers.targets[pos[c]++] = i;
+    }
+
+    spdlog::info("Call graph: {} functions, {} calls", this->size(),
+                 m_callees.targets.size());
+}
+
+tl::optional<u32> CallGraph::index_of(RDAddress entry) const {
+    auto it = std::ranges::lower_bound(m_entries, entry);
+
+    if(it != m_entries.end() && *it == entry)
+        return static_cast<u32>(std::distance(m_entries.begin(), it));
+
+    return tl::nullopt;
+}
+
+std::span<const u32> CallGraph::callees(u32 f) const {
+    ct_assume(f < this->size());
+    return m_callees.at(f);
+}
+
+std::span<const u32> CallGraph::callers(u32 f) const {
+    ct_assume(f < this->size());
+    return m_callers.at(f);
+}
+
+template<typename Function>
+void CallGraph::bfs(const CSR& csr, u32 start, usize depth, Function f) const {
+    usize nwords = (this->size() + 63) / 64;
+    Bitset visited(nwords), frontier(nwords), next(nwords);
+    set_bit(visited, start);
+    set_bit(frontier, start);
+
+    for(usize d = 0; !depth || d < depth; d++) {
+        bool empty = true;
+
+        // Frontiers are bitsets: each level is a linear scan over words
+        for(usize w = 0; w < nwords; w++) {
+            for(u64 bits = frontier[w]; bits; bits &= bits - 1) {
+                auto src = static_cast<u32>(w * 64 + std::countr_zero(bits));
+
+                for(u32 dst : csr.at(src)) {
+                    if(f(src, dst)) return;
+                    if(test_bit(visited, dst)) continue;
+
+                    set_bit(visited, dst);
+                    set_bit(next, dst);
+                    empty = false;
+                }
+            }
+        }
+
+        if(empty) break;
+        std::swap(frontier, next);
+        std::ranges::fill(next, 0);
+    }
+}
+
+CallGraph::Bitset CallGraph::closure(u32 f, bool callers) const {
+    ct_assume(f < this->size());
+    Bitset res((this->size() + 63) / 64);
+
+    this->bfs(callers ? m_callers : m_callees, f, 0, [&](u32, u32 dst) {
+        set_bit(res, dst);
+        return false;
+    });
+
+    return res;
+}
+
+bool CallGraph::reaches(u32 from, u32 to) const {
+    ct_assume(from < this->size() && to < this->size());
+    bool found = false;
+
+    this->bfs(m_callees, from, 0, [&](u32, u32 dst) {
+        found = dst == to;
+        return found;
+    });
+
+    return found;
+}
+
+void CallGraph::export_graph(u32 f, usize depth, StyledGraph& g) const {
+    ct_assume(f < this->size());
+    g.clear();
+    g.set_address(m_entries[f]);
+
+    std::vector<RDGraphNode> nodes(this->size());
+
+    auto get_node = [&](u32 idx) {
+        if(!nodes[idx]) nodes[idx] = g.add_datanode(uptr{m_entries[idx]});
+        return nodes[idx];
+    };
+
+    g.set_root(get_node(f));
+
+    this->bfs(m_callees, f, depth, [&](u32 src, u32 dst) {
+        g.add_edge(get_node(src), get_node(dst));
+        return false;
+    });
+}
+
+} // namespace redasm
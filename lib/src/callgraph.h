@@ -0,0 +1,57 @@
+#pragma once
+
+#include <redasm/types.h>
+#include <span>
+#include <tl/optional.hpp>
+#include <vector>
+
+namespace redasm {
+
+class StyledGraph;
+
+// Immutable call graph over 'program.functions' indices, stored as
+// forward (callees) and reverse (callers) CSR arrays, built once per
+// call graph generation (see Context::call_generation())
+class CallGraph {
+public:
+    using Bitset = std::vector<u64>;
+
+public:
+    explicit CallGraph(usize generation);
+    [[nodiscard]] usize generation() const { return m_generation; }
+    [[nodiscard]] usize size() const { return m_entries.size(); }
+    [[nodiscard]] RDAddress entry(u32 f) const { return m_entries[f]; }
+    [[nodiscard]] tl::optional<u32> index_of(RDAddress entry) const;
+    [[nodiscard]] std::span<const u32> callees(u32 f) const;
+    [[nodiscard]] std::span<const u32> callers(u32 f) const;
+
+    // Every function transitively reached from 'f' (or reaching 'f'),
+    // 'f' itself is included only when it is part of a cycle
+    [[nodiscard]] Bitset closure(u32 f, bool callers) const;
+    [[nodiscard]] bool reaches(u32 from, u32 to) const;
+
+    // Subgraph of the functions reachable from 'f' within 'depth' calls
+    // (0 = unlimited), node data holds the function entry address
+    void export_graph(u32 f, usize depth, StyledGraph& g) const;
+
+private:
+    struct CSR {
+        std::vector<u32> offsets, targets;
+
+        [[nodiscard]] std::span<const u32> at(u32 f) const {
+            return {targets.data() + offsets[f],
+                    targets.data() + offsets[f + 1]};
+        }
+    };
+
+    // Visits 'csr' breadth first, 'f' returns true to stop
+    template<typename Function>
+    void bfs(const CSR& csr, u32 start, usize depth, Function f) const;
+
+private:
+    std::vector<RDAddress> m_entries;
+    CSR m_callees, m_callers;
+    usize m_generation;
+};
+
+} // namespace redasm
@@ -26,50 +26,27 @@ namespace redasm {
 
 namespace {
 
-std::string_view get_refname(usize reftype) {
-    switch(reftype) {
-        case DR_READ: return "READ";
-        case DR_WRITE: return "WRITE";
-        case DR_ADDRESS: return "ADDRESS";
-        case CR_JUMP: return "JUMP";
-        case CR_CALL: return "CALL";
-        default: break;
-    }
-
-    ct_unreachable;
-}
-
 void add_noncodeproblem(const RDSegment* seg, RDAddress address, usize type) {
     if(seg) {
-        state::context->add_problem(
-            address, fmt::format("Trying to {} in non-code segment '{}'",
-                                 get_refname(type), seg->name));
-    }
-    else {
-        state::context->add_problem(
-            address,
-            fmt::format("Trying to {} outside of segments", get_refname(type)));
+        state::context->add_problem(address, PROBLEM_NONCODE_SEGMENT, type,
+                                    seg->name);
     }
+    else
+        state::context->add_problem(address, PROBLEM_OUTSIDE_SEGMENTS, type);
 }
 
 } // namespace
 
-Context::Context(RDBuffer* file) {
-    slice_init(&this->problems, nullptr, nullptr);
-    this->program.file = file;
-}
+Context::Context(RDBuffer* file) { this->program.file = file; }
 
 Context::~Context() {
+    this->prelayout.cancel(); // Workers store into the layout cache
     delete m_database;
     delete this->worker;
 
     if(state::context == this) rdbuffer_destroy(this->program.file);
     pm::destroy_instance(this->processorplugin, this->processor);
     pm::destroy_instance(this->loaderplugin, this->loader);
-
-    RDProblem* p;
-    slice_foreach(p, &this->problems) delete[] p->problem;
-    slice_destroy(&this->problems);
 }
 
 bool Context::parse(const RDLoaderPlugin* plugin, const RDLoaderRequest* req) {
@@ -100,7 +77,8 @@ bool Context::load(const RDProcessorPlugin* plugin) {
     ct_assume(this->loaderplugin);
     ct_assume(this->processorplugin);
 
-    m_database = new Database{plugin->id, this->program.file->source};
+    m_database = new Database{plugin->id, this->program.file->source,
+                              state::params.flags};
     this->processor = pm::create_instance(plugin);
     this->worker = new Worker{};
 
@@ -148,6 +126,7 @@ tl::optional<uptr> Context::get_userdata(const std::string& k) const {
 }
 
 bool Context::set_function(RDAddress address, usize flags) {
+    this->bump_revision();
     address = this->normalize_address(address, false);
 
     if(RDSegment* seg = this->program.find_segment(address); seg) {
@@ -162,7 +141,7 @@ bool Context::set_function(RDAddress address, usize flags) {
         }
     }
 
-    this->add_problem(address, "Invalid function location");
+    this->add_problem(address, PROBLEM_INVALID_FUNCTION);
     return false;
 }
 
@@ -170,25 +149,24 @@ bool Context::set_entry(RDAddress address, const std::string& name) {
     if(this->set_function(address, SF_ENTRY))
         return this->set_name(address, name, SN_EXPORT);
 
-    this->add_problem(address, "Invalid entry location");
+    this->add_problem(address, PROBLEM_INVALID_ENTRY);
     return false;
 }
 
 void Context::add_ref(RDAddress fromaddr, RDAddress toaddr, usize type) {
+    this->bump_revision();
     fromaddr = this->normalize_address(fromaddr);
     toaddr = this->normalize_address(toaddr);
     RDSegment* fromseg = this->program.find_segment(fromaddr);
     RDSegment* toseg = this->program.find_segment(toaddr);
 
     if(!fromseg) {
-        this->add_problem(fromaddr, fmt::format("Invalid FROM {} reference",
-                                                get_refname(type), fromaddr));
+        this->add_problem(fromaddr, PROBLEM_INVALID_FROM_REF, type);
         return;
     }
 
     if(!toseg) {
-        this->add_problem(
-            toaddr, fmt::format("Invalid TO {} reference", get_refname(type)));
+        this->add_problem(toaddr, PROBLEM_INVALID_TO_REF, type);
         return;
     }
 
@@ -204,6 +182,7 @@ void Context::add_ref(RDAddress fromaddr, RDAddress toaddr, usize type) {
 
         case CR_JUMP: {
             this->m_database->add_ref(fromaddr, toaddr, type);
+            this->invalidate_jumps();
             memory::set_flag(fromseg, fromaddr, BF_REFSFROM);
             memory::set_flag(toseg, toaddr, BF_JUMPDST | BF_REFSTO);
 
@@ -219,6 +198,7 @@ void Context::add_ref(RDAddress fromaddr, RDAddress toaddr, usize type) {
 
         case CR_CALL: {
             this->m_database->add_ref(fromaddr, toaddr, type);
+            this->invalidate_call_graph();
             memory::set_flag(fromseg, fromaddr, BF_REFSFROM);
             memory::set_flag(toseg, toaddr, BF_FUNCTION | BF_REFSTO);
 
@@ -241,6 +221,8 @@ bool Context::set_comment(RDAddress address, std::string_view comment) {
     if(!seg) return false;
 
     this->m_database->set_comment(address, comment);
+    this->symbolindex.invalidate();
+    this->bump_revision();
     memory::set_flag(seg, address, BF_CODE, !comment.empty());
     return true;
 }
@@ -251,6 +233,7 @@ bool Context::set_type(RDAddress address, std::string_view tname, usize flags) {
 }
 
 bool Context::set_type(RDAddress address, RDType t, usize flags) {
+    this->bump_revision();
     RDSegment* seg = this->program.find_segment(address);
     if(!seg) {
         spdlog::warn("set_type: Invalid address");
@@ -347,6 +330,15 @@ tl::optional<u64> Context::get_sreg(RDAddress address, int sreg) const {
     return tl::nullopt;
 }
 
+tl::optional<RDDatabaseMetrics> Context::get_db_metrics() const {
+    if(m_database) return m_database->get_metrics();
+    return tl::nullopt;
+}
+
+bool Context::save_db(std::string_view filepath) const {
+    return m_database && m_database->save(filepath);
+}
+
 Database::SRegList Context::get_sregs() const {
     return m_database->get_sregs();
 }
@@ -363,6 +355,7 @@ RDAddress Context::normalize_address(RDAddress address, bool query) const {
 
 void Context::set_sreg(RDAddress address, int sreg, const RDRegValue& val,
                        const tl::optional<RDAddress>& fromaddr) {
+    this->bump_revision();
     if(this->program.set_sreg(address, sreg, val))
         m_database->set_sreg(address, sreg, val, fromaddr);
 }
@@ -417,14 +410,55 @@ std::string Context::get_name(RDAddress address, bool autoname) const {
 bool Context::set_name(RDAddress address, const std::string& name,
                        usize flags) {
     address = this->normalize_address(address);
-    RDSegment* seg = this->program.find_segment(address);
+    auto dbname = this->check_name(address, name, flags, {});
+    if(!dbname) return false;
+
+    this->apply_name(address, *dbname, flags);
+    m_database->set_name(address, *dbname);
+    this->invalidate_symbols();
+    this->bump_revision();
+    return true;
+}
+
+usize Context::set_names(const std::vector<NameRequest>& names) {
+    std::unordered_set<std::string> pending;
+    Database::NameList dbnames;
+    std::vector<usize> dbflags;
+
+    // Lookups first: interleaving them with writes forces a flush per name
+    for(const NameRequest& req : names) {
+        RDAddress address = this->normalize_address(req.address);
+        auto dbname = this->check_name(address, req.name, req.flags, pending);
+        if(!dbname) continue;
+
+        if(!dbname->empty()) pending.insert(*dbname);
+        dbnames.emplace_back(address, std::move(*dbname));
+        dbflags.push_back(req.flags);
+    }
+
+    for(usize i = 0; i < dbnames.size(); i++)
+        this->apply_name(dbnames[i].first, dbnames[i].second, dbflags[i]);
+
+    m_database->set_names(dbnames);
+
+    if(!dbnames.empty()) {
+        this->invalidate_symbols();
+        this->bump_revision();
+    }
+
+    return dbnames.size();
+}
+
+tl::optional<std::string>
+Context::check_name(RDAddress address, const std::string& name, usize flags,
+                    const std::unordered_set<std::string>& pending) {
+    const RDSegment* seg = this->program.find_segment(address);
 
     if(!seg) {
         if(!(flags & SN_NOWARN))
-            this->add_problem(address,
-                              "Cannot set name, address out of bounds");
+            this->add_problem(address, PROBLEM_NAME_OUT_OF_BOUNDS);
 
-        return false;
+        return tl::nullopt;
     }
 
     std::string dbname = name;
@@ -437,38 +471,66 @@ bool Context::set_name(RDAddress address, const std::string& name,
     if(!name.empty()) {
         if(memory::has_flag(seg, address, BF_NAME)) {
             if(!(flags & SN_NOWARN)) {
-                this->add_problem(
-                    address,
-                    fmt::format("Name already set @ {:x} (trying to set '{}')",
-                                address, name));
+                this->add_problem(address, PROBLEM_NAME_ALREADY_SET, 0, name);
             }
-            return false;
+            return tl::nullopt;
         }
 
-        auto nameidx = this->get_address(dbname, true);
+        auto is_taken = [&](const std::string& n) {
+            return pending.contains(n) || this->get_address(n, true);
+        };
+
+        bool taken = is_taken(dbname);
 
-        if(nameidx && (flags & SN_FORCE)) {
+        if(taken && (flags & SN_FORCE)) {
             usize n = 0;
 
-            while(nameidx) {
+            while(taken) {
                 dbname = fmt::format("{}_{}", name, ++n);
-                nameidx = this->get_address(dbname, true);
+                taken = is_taken(dbname);
             }
         }
-        else if(nameidx) {
+        else if(taken) {
             if(!(flags & SN_NOWARN)) {
-                this->add_problem(
-                    address, fmt::format("name '{}' already exists", name));
+                this->add_problem(address, PROBLEM_NAME_EXISTS, 0, name);
             }
-            return false;
+            return tl::nullopt;
         }
     }
 
+    return dbname;
+}
+
+void Context::apply_name(RDAddress address, const std::string& dbname,
+                         usize flags) {
+    RDSegment* seg = this->program.find_segment(address);
+    ct_assume(seg);
+
     memory::set_flag(seg, address, BF_EXPORT, flags & SN_EXPORT);
     memory::set_flag(seg, address, BF_IMPORT, flags & SN_IMPORT);
     memory::set_flag(seg, address, BF_NAME, !dbname.empty());
-    m_database->set_name(address, dbname);
-    return true;
+}
+
+std::string_view Context::get_name(RDAddress address,
+                                   FrameArena& arena) const {
+    const RDSegment* seg = this->program.find_segment(address);
+
+    // 'loc_' and 'sub_' names are formatted in place
+    if(seg && !memory::has_flag(seg, address, BF_NAME) &&
+       !memory::has_flag(seg, address, BF_TYPE)) {
+        std::string_view prefix =
+            memory::has_flag(seg, address, BF_FUNCTION) ? "sub_" : "loc_";
+
+        char* p = arena.allocate(prefix.size() + utils::INT_CHARS);
+        std::copy(prefix.begin(), prefix.end(), p);
+
+        usize n = prefix.size() + utils::to_chars(p + prefix.size(), address,
+                                                  16, false, seg->bits);
+        arena.shrink(p, n);
+        return {p, n};
+    }
+
+    return arena.copy(this->get_name(address));
 }
 
 std::string Context::get_comment(RDAddress address) const {
@@ -477,6 +539,34 @@ std::string Context::get_comment(RDAddress address) const {
     return m_database->get_comment(address);
 }
 
+Database::CommentList Context::get_comments() const {
+    return m_database->get_comments();
+}
+
+Database::RangeRefList Context::get_refs_from_range(RDAddress start,
+                                                    RDAddress end) const {
+    return m_database->get_refs_from_range(start, end);
+}
+
+Database::RangeRefList Context::get_refs_to_range(RDAddress start,
+                                                  RDAddress end) const {
+    return m_database->get_refs_to_range(start, end);
+}
+
+Database::CommentList Context::get_comments_range(RDAddress start,
+                                                  RDAddress end) const {
+    return m_database->get_comments_range(start, end);
+}
+
+Database::NameList Context::get_names_range(RDAddress start,
+                                            RDAddress end) const {
+    return m_database->get_names_range(start, end);
+}
+
+Database::RangeRefList Context::get_refs_by_type(usize type) const {
+    return m_database->get_refs_by_type(type);
+}
+
 Database::RefList Context::get_refs_from_type(RDAddress fromaddr,
                                               usize type) const {
     const RDSegment* seg = this->program.find_segment(fromaddr);
@@ -503,13 +593,46 @@ Database::RefList Context::get_refs_to(RDAddress toaddr) const {
     return m_database->get_refs_to(toaddr);
 }
 
+void Context::invalidate_symbols() {
+    this->symbolindex.invalidate();
+    m_symbolgeneration.fetch_add(1);
+}
+
+std::shared_ptr<const SymbolTable> Context::get_symbol_table(usize kind) {
+    ct_assume(kind < SYMBOLTABLE_COUNT);
+
+    std::scoped_lock lock{m_symtablemutex};
+    std::shared_ptr<const SymbolTable>& t = m_symboltables[kind];
+    usize gen = this->symbol_generation();
+
+    if(!t || t->generation() != gen)
+        t = std::make_shared<const SymbolTable>(kind, gen);
+
+    return t;
+}
+
+std::shared_ptr<const CallGraph> Context::get_call_graph() {
+    std::scoped_lock lock{m_callgraphmutex};
+    usize gen = this->call_generation();
+
+    if(!m_callgraph || m_callgraph->generation() != gen)
+        m_callgraph = std::make_shared<const CallGraph>(gen);
+
+    return m_callgraph;
+}
+
 void Context::add_problem(RDAddress address, std::string_view s) {
-    spdlog::warn("add_problem(): {:x} = {}", address, s);
-    slice_push(&this->problems, {address, utils::copy_str(s)});
+    this->problems.add(address, PROBLEM_CUSTOM, 0, s);
+}
+
+void Context::add_problem(RDAddress address, usize code, u64 arg,
+                          std::string_view s) {
+    this->problems.add(address, code, arg, s);
 }
 
 bool Context::add_segment(std::string_view name, RDAddress start, RDAddress end,
                           u32 perm, u32 bits) {
+    this->bump_revision();
     if(!this->program.add_segment(name, start, end, perm, bits)) return false;
 
     // Try to initialize segment registers for this segment
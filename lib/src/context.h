@@ -1,18 +1,33 @@
 #pragma once
 
+#include "callgraph.h"
 #include "database/database.h"
 #include "disasm/worker.h"
+#include "graph/layouts/layoutcache.h"
+#include "graph/layouts/prelayout.h"
+#include "jumpindex.h"
 #include "listing.h"
 #include "memory/program.h"
+#include "problemstore.h"
+#include "rdil/ilcache.h"
 #include "signature/signature.h"
+#include "surface/framearena.h"
+#include "symbolindex.h"
+#include "symboltable.h"
 #include "typing/typing.h"
 #include <redasm/analyzer.h>
 #include <redasm/loader.h>
 #include <redasm/processor.h>
 #include <redasm/types.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <spdlog/spdlog.h>
 #include <string_view>
+#include <unordered_set>
+#include <vector>
 
 namespace redasm {
 
@@ -25,6 +40,12 @@ class Context {
     };
 
 public:
+    struct NameRequest {
+        RDAddress address;
+        std::string name;
+        usize flags;
+    };
+
     static constexpr usize DEFAULT_MIN_STRING = 4;
 
     explicit Context(RDBuffer* file);
@@ -36,18 +57,54 @@ public:
     bool set_function(RDAddress address, usize flags);
     bool set_entry(RDAddress address, const std::string& name = {});
     void add_problem(RDAddress address, std::string_view s);
+    void add_problem(RDAddress address, usize code, u64 arg = 0,
+                     std::string_view s = {});
     bool add_segment(std::string_view name, RDAddress start, RDAddress end,
                      u32 perm, u32 bits);
 
+    // Changes on every update that can affect the rendered listing
+    usize revision() const { return m_revision.load(); }
+    void bump_revision() { m_revision.fetch_add(1); }
+
+    // Changes when symbol lists or names change (listing rebuilds, renames)
+    usize symbol_generation() const { return m_symbolgeneration.load(); }
+    void invalidate_symbols();
+
+    // Changes when functions or call references change
+    usize call_generation() const { return m_callgeneration.load(); }
+    void invalidate_call_graph() { m_callgeneration.fetch_add(1); }
+
+    // Changes when jump references or their endpoints' code flags change
+    usize jump_generation() const { return m_jumpgeneration.load(); }
+    void invalidate_jumps() { m_jumpgeneration.fetch_add(1); }
+    std::shared_ptr<const SymbolTable> get_symbol_table(usize kind);
+    std::shared_ptr<const CallGraph> get_call_graph();
+
 public: // Database Interface
     void add_ref(RDAddress fromaddr, RDAddress toaddr, usize type);
     bool set_comment(RDAddress address, std::string_view comment = {});
     bool set_type(RDAddress address, std::string_view tname, usize flags);
     bool set_type(RDAddress address, RDType t, usize flags);
     bool set_name(RDAddress address, const std::string& name, usize flags);
+
+    // Checks every name before writing, the database then commits them in
+    // a single batch. Returns the number of names applied
+    usize set_names(const std::vector<NameRequest>& names);
     tl::optional<RDType> get_type(RDAddress address) const;
     std::string get_name(RDAddress address, bool autoname = true) const;
+
+    // Same as get_name(), the result is valid until 'arena' is reset
+    std::string_view get_name(RDAddress address, FrameArena& arena) const;
     std::string get_comment(RDAddress address) const;
+    Database::CommentList get_comments() const;
+    Database::RangeRefList get_refs_from_range(RDAddress start,
+                                               RDAddress end) const;
+    Database::RangeRefList get_refs_to_range(RDAddress start,
+                                             RDAddress end) const;
+    Database::CommentList get_comments_range(RDAddress start,
+                                             RDAddress end) const;
+    Database::NameList get_names_range(RDAddress start, RDAddress end) const;
+    Database::RangeRefList get_refs_by_type(usize type) const;
     Database::RefList get_refs_from_type(RDAddress fromaddr, usize type) const;
     Database::RefList get_refs_from(RDAddress fromaddr) const;
     Database::RefList get_refs_to_type(RDAddress fromaddr, usize type) const;
@@ -57,6 +114,9 @@ public: // Database Interface
     tl::optional<u64> get_sreg(RDAddress address, int reg) const;
     Database::SRegList get_sregs() const;
     RDAddress normalize_address(RDAddress address, bool query = true) const;
+    tl::optional<RDDatabaseMetrics> get_db_metrics() const;
+    Database* get_database() { return m_database; }
+    bool save_db(std::string_view filepath) const;
 
     tl::optional<RDAddress> get_address(std::string_view name,
                                         bool onlydb = false) const;
@@ -75,15 +135,37 @@ public: // Plugins
 public:
     Program program;
     signature::SignatureManager signatures;
-    RDProblemSlice problems;
+    ProblemStore problems;
     tl::optional<RDAddress> entrypoint;
     Worker* worker{nullptr};
     Listing listing;
+    SymbolIndex symbolindex;
+    JumpIndex jumpindex;
+    LayoutCache layoutcache;
+    PreLayout prelayout;
+    rdil::ILCache rdilcache;
     typing::Types types;
     int minstring{DEFAULT_MIN_STRING};
 
+private:
+    tl::optional<std::string>
+    check_name(RDAddress address, const std::string& name, usize flags,
+               const std::unordered_set<std::string>& pending);
+
+    void apply_name(RDAddress address, const std::string& dbname,
+                    usize flags);
+
 private:
     Database* m_database{nullptr};
+    std::atomic<usize> m_revision{0};
+    std::atomic<usize> m_symbolgeneration{0};
+    std::atomic<usize> m_callgeneration{0};
+    std::atomic<usize> m_jumpgeneration{0};
+    std::array<std::shared_ptr<const SymbolTable>, SYMBOLTABLE_COUNT>
+        m_symboltables;
+    std::mutex m_symtablemutex;
+    std::shared_ptr<const CallGraph> m_callgraph;
+    std::mutex m_callgraphmutex;
 };
 
 } // namespace redasm
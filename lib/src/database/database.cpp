@@ -1,5 +1,6 @@
 #include "database.h"
 #include <cctype>
+#include <chrono>
 #include <filesystem>
 #include <spdlog/spdlog.h>
 
@@ -29,6 +30,12 @@ struct SQLQueries {
         GET_SREGS,
         SET_USERDATA,
         GET_USERDATA,
+        GET_COMMENTS,
+        GET_REFS_FROM_RANGE,
+        GET_REFS_TO_RANGE,
+        GET_COMMENTS_RANGE,
+        GET_NAMES_RANGE,
+        GET_REFS_BY_TYPE,
     };
 };
 
@@ -36,6 +43,30 @@ namespace {
 
 constexpr std::string_view DATABASE_FILE = "database.sqlite";
 
+bool sql_backup(sqlite3* src, sqlite3* dst) {
+    sqlite3_backup* b = sqlite3_backup_init(dst, "main", src, "main");
+    if(!b) return false;
+
+    sqlite3_backup_step(b, -1);
+    return sqlite3_backup_finish(b) == SQLITE_OK;
+}
+
+bool sql_exec(sqlite3* db, const char* q) {
+    char* err = nullptr;
+    if(sqlite3_exec(db, q, nullptr, nullptr, &err) == SQLITE_OK) return true;
+
+    spdlog::error("SQL: '{}' failed: {}", q, err ? err : sqlite3_errmsg(db));
+    sqlite3_free(err);
+    return false;
+}
+
+template<typename T>
+void atomic_max(std::atomic<T>& a, T v) {
+    T curr = a.load(std::memory_order_relaxed);
+    while(curr < v && !a.compare_exchange_weak(curr, v))
+        ;
+}
+
 // clang-format off
 template<typename T>
 concept SQLBindable =
@@ -122,6 +153,8 @@ constexpr std::string_view DB_SCHEMA = R"(
         UNIQUE(fromaddr, toaddr)
     );
 
+    CREATE INDEX RefsTo ON Refs(toaddr);
+
     CREATE TABLE Types(
         address INTEGER PRIMARY KEY,
         name TEXT NOT NULL,
@@ -144,29 +177,50 @@ constexpr std::string_view DB_SCHEMA = R"(
 
 } // namespace
 
-Database::Database(std::string_view ldrid, std::string_view source) {
+Database::Database(std::string_view ldrid, std::string_view source,
+                   usize flags) {
     ct_assume(!source.empty());
 
-    m_dbname = fs::path{source}.filename().replace_extension(".rdb").string();
-    m_dbroot = (fs::path{source}.remove_filename() / m_dbname / ldrid).string();
-    ct_assume(!m_dbroot.empty());
+    if(flags & IF_MEMORYDB) {
+        spdlog::info("Loading in-memory database");
+        ct_assume(!sqlite3_open(":memory:", &m_db));
+    }
+    else {
+        m_dbname =
+            fs::path{source}.filename().replace_extension(".rdb").string();
+        m_dbroot =
+            (fs::path{source}.remove_filename() / m_dbname / ldrid).string();
+        ct_assume(!m_dbroot.empty());
 
-    if(fs::exists(m_dbroot)) // Remove old database
-        fs::remove_all(m_dbroot);
+        if(fs::exists(m_dbroot)) // Remove old database
+            fs::remove_all(m_dbroot);
 
-    spdlog::info("Loading database: {}", m_dbroot);
-    fs::create_directories(m_dbroot);
+        spdlog::info("Loading database: {}", m_dbroot);
+        fs::create_directories(m_dbroot);
 
-    fs::path dbfile = fs::path{m_dbroot} / DATABASE_FILE;
-    ct_assume(!sqlite3_open(dbfile.string().c_str(), &m_db));
+        fs::path dbfile = fs::path{m_dbroot} / DATABASE_FILE;
+        ct_assume(!sqlite3_open(dbfile.string().c_str(), &m_db));
+    }
 
     char* errmsg = nullptr;
     int rc = sqlite3_exec(m_db, DB_SCHEMA.data(), nullptr, nullptr, &errmsg);
 
     if(rc != SQLITE_OK) ct_exceptf("SQLite Error: %s", errmsg);
+
+    if(flags & IF_ASYNCDB) {
+        spdlog::info("Database: async writer enabled");
+        m_writer = std::thread{&Database::writer_loop, this};
+    }
 }
 
 Database::~Database() {
+    if(m_writer.joinable()) {
+        m_stop.store(true);
+        m_enqueued.fetch_add(1); // Wake up the writer
+        m_enqueued.notify_one();
+        m_writer.join();
+    }
+
     if(m_db) {
         for(const auto& [_, stmt] : m_queries)
             sqlite3_finalize(stmt);
@@ -175,6 +229,8 @@ Database::~Database() {
         m_db = nullptr;
     }
 
+    if(m_dbroot.empty()) return; // In-memory database
+
     if(fs::exists(m_dbroot)) {
         spdlog::info("Unloading database: {}", m_dbroot);
         fs::remove_all(m_dbroot);
@@ -207,8 +263,320 @@ sqlite3_stmt* Database::prepare_query(int q, std::string_view s) const {
     return stmt;
 }
 
+void Database::flush() const {
+    if(!m_writer.joinable()) return;
+
+    u64 target = m_enqueued.load(std::memory_order_acquire);
+    u64 applied = m_applied.load(std::memory_order_acquire);
+
+    while(applied < target) {
+        m_enqueued.notify_one();
+        m_applied.wait(applied);
+        applied = m_applied.load(std::memory_order_acquire);
+    }
+}
+
+RDDatabaseMetrics Database::get_metrics() const {
+    u64 enqueued = m_enqueued.load(), applied = m_applied.load();
+
+    return {
+        .pending = static_cast<usize>(enqueued > applied ? enqueued - applied
+                                                         : 0),
+        .highwatermark = m_highwatermark.load(),
+        .batches = m_nbatches.load(),
+        .lastflushus = m_lastflushus.load(),
+        .maxflushus = m_maxflushus.load(),
+    };
+}
+
+std::string Database::serialize() const {
+    auto lock = this->sync();
+
+    sqlite3_int64 n = 0;
+    u8* data = sqlite3_serialize(m_db, "main", &n, 0);
+    if(!data) return {};
+
+    std::string res{reinterpret_cast<const char*>(data), static_cast<usize>(n)};
+    sqlite3_free(data);
+    return res;
+}
+
+bool Database::save(std::string_view filepath) const {
+    auto lock = this->sync();
+
+    sqlite3* dstdb = nullptr;
+    std::string fp{filepath};
+    bool ok = sqlite3_open(fp.c_str(), &dstdb) == SQLITE_OK &&
+              sql_backup(m_db, dstdb);
+
+    if(ok)
+        spdlog::info("Database saved: {}", fp);
+    else
+        spdlog::error("Database: cannot save '{}'", fp);
+
+    sqlite3_close(dstdb);
+    return ok;
+}
+
+bool Database::deserialize(std::string_view data) {
+    auto lock = this->sync();
+
+    // Load the image in a temporary database, then copy it in place
+    sqlite3* tmpdb = nullptr;
+    if(sqlite3_open(":memory:", &tmpdb) != SQLITE_OK) return false;
+
+    auto* buf = static_cast<u8*>(sqlite3_malloc64(data.size()));
+
+    if(!buf) {
+        spdlog::error("Database: cannot allocate {} bytes", data.size());
+        sqlite3_close(tmpdb);
+        return false;
+    }
+
+    std::copy(data.begin(), data.end(), buf);
+
+    int rc = sqlite3_deserialize(
+        tmpdb, "main", buf, data.size(), data.size(),
+        SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE);
+
+    // Cached statements must not be active while the backup overwrites m_db
+    for(const auto& [_, stmt] : m_queries)
+        sqlite3_finalize(stmt);
+
+    m_queries.clear();
+
+    bool ok = rc == SQLITE_OK && sql_backup(tmpdb, m_db);
+    if(!ok) spdlog::error("Database: {}", sqlite3_errmsg(m_db));
+    sqlite3_close(tmpdb);
+    return ok;
+}
+
+std::unique_lock<std::mutex> Database::sync() const {
+    // Cached statements are shared: the database is locked even without
+    // the writer thread, listing shards query it concurrently
+    this->flush();
+    return std::unique_lock{m_dbmutex};
+}
+
+void Database::enqueue(Mutation m) {
+    if(!m_writer.joinable()) {
+        std::scoped_lock lock{m_dbmutex};
+        this->apply(m);
+        return;
+    }
+
+    // Lock-free push (multiple producers, single consumer)
+    auto* item = new Mutation{std::move(m)};
+    item->next = m_pending.load(std::memory_order_relaxed);
+
+    while(!m_pending.compare_exchange_weak(item->next, item,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed))
+        ;
+
+    u64 n = m_enqueued.fetch_add(1, std::memory_order_acq_rel) + 1;
+    u64 applied = m_applied.load(std::memory_order_relaxed);
+    if(n > applied) atomic_max<usize>(m_highwatermark, n - applied);
+    m_enqueued.notify_one();
+}
+
+void Database::enqueue_batch(std::vector<Mutation> items) {
+    if(items.empty()) return;
+
+    // Link items in LIFO order, like single pushes do
+    Mutation *head = nullptr, *tail = nullptr;
+
+    for(Mutation& m : items) {
+        auto* item = new Mutation{std::move(m)};
+        item->next = head;
+        head = item;
+        if(!tail) tail = item;
+    }
+
+    if(!m_writer.joinable()) {
+        this->apply_batch(head);
+        return;
+    }
+
+    // The whole chain is published at once, so the writer thread applies
+    // it within the same transaction
+    tail->next = m_pending.load(std::memory_order_relaxed);
+
+    while(!m_pending.compare_exchange_weak(tail->next, head,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed))
+        ;
+
+    u64 n = m_enqueued.fetch_add(items.size(), std::memory_order_acq_rel) +
+            items.size();
+
+    u64 applied = m_applied.load(std::memory_order_relaxed);
+    if(n > applied) atomic_max<usize>(m_highwatermark, n - applied);
+    m_enqueued.notify_one();
+}
+
+void Database::apply_batch(Mutation* head) {
+    // Producers push in LIFO order, restore insertion order
+    Mutation* items = nullptr;
+
+    while(head) {
+        Mutation* next = head->next;
+        head->next = items;
+        items = head;
+        head = next;
+    }
+
+    std::scoped_lock lock{m_dbmutex};
+    auto t = std::chrono::steady_clock::now();
+
+    // Without a transaction every mutation is committed on its own
+    bool transaction = sql_exec(m_db, "BEGIN TRANSACTION");
+    usize n = 0;
+
+    while(items) {
+        Mutation* next = items->next;
+        this->apply(*items);
+        delete items;
+        items = next;
+        n++;
+    }
+
+    if(transaction && !sql_exec(m_db, "COMMIT")) {
+        sql_exec(m_db, "ROLLBACK");
+        spdlog::error("Database: batch of {} mutation(s) lost", n);
+    }
+
+    auto us = static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t)
+            .count());
+
+    m_lastflushus.store(us);
+    atomic_max(m_maxflushus, us);
+    m_nbatches.fetch_add(1);
+}
+
+void Database::writer_loop() {
+    for(;;) {
+        u64 n = m_enqueued.load(std::memory_order_acquire);
+        Mutation* head = m_pending.exchange(nullptr, std::memory_order_acquire);
+        if(head) this->apply_batch(head);
+
+        m_applied.store(n, std::memory_order_release);
+        m_applied.notify_all();
+
+        if(m_stop.load() && !m_pending.load()) break;
+        if(!head) m_enqueued.wait(n);
+    }
+}
+
+void Database::apply(const Mutation& m) {
+    switch(m.kind) {
+        case Mutation::ADD_REF: {
+            sqlite3_stmt* stmt = this->prepare_query(SQLQueries::ADD_REF, R"(
+                INSERT INTO Refs
+                    VALUES (:fromaddr, :toaddr, :type)
+                ON CONFLICT DO 
+                    UPDATE SET type = EXCLUDED.type
+            )");
+
+            sql_bindparam(m_db, stmt, ":fromaddr", m.address);
+            sql_bindparam(m_db, stmt, ":toaddr", m.value);
+            sql_bindparam(m_db, stmt, ":type", m.n);
+            sql_step(m_db, stmt);
+            break;
+        }
+
+        case Mutation::SET_COMMENT: {
+            sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_COMMENT, R"(
+                INSERT INTO Comments (address, comment) 
+                    VALUES (:address, :comment)
+                ON CONFLICT DO 
+                    UPDATE SET comment = EXCLUDED.comment
+            )");
+
+            sql_bindparam(m_db, stmt, ":address", m.address);
+            sql_bindparam(m_db, stmt, ":comment", m.s);
+            sql_step(m_db, stmt);
+            break;
+        }
+
+        case Mutation::SET_NAME: {
+            sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_NAME, R"(
+                INSERT INTO Names
+                    VALUES (:address, :name)
+                ON CONFLICT DO 
+                    UPDATE SET name = EXCLUDED.name
+            )");
+
+            sql_bindparam(m_db, stmt, ":address", m.address);
+            sql_bindparam(m_db, stmt, ":name", m.s);
+            sql_step(m_db, stmt);
+            break;
+        }
+
+        case Mutation::SET_TYPE: {
+            sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_TYPE, R"(
+                INSERT INTO Types
+                    VALUES (:address, :name, :n)
+                ON CONFLICT DO 
+                    UPDATE SET name = EXCLUDED.name, n = EXCLUDED.n
+            )");
+
+            sql_bindparam(m_db, stmt, ":address", m.address);
+            sql_bindparam(m_db, stmt, ":name", m.s);
+            sql_bindparam(m_db, stmt, ":n", m.n);
+            sql_step(m_db, stmt);
+            break;
+        }
+
+        case Mutation::SET_SREG: {
+            sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_SREG, R"(
+                INSERT INTO SegmentRegisters (address, reg, value, fromaddr) 
+                    VALUES (:address, :reg, :val, :fromaddr)
+                ON CONFLICT DO 
+                    UPDATE SET reg = EXCLUDED.reg
+            )");
+
+            sql_bindparam(m_db, stmt, ":address", m.address);
+            sql_bindparam(m_db, stmt, ":reg", m.reg);
+
+            if(m.regval.ok)
+                sql_bindparam(m_db, stmt, ":val", m.regval.value);
+            else
+                sql_bindparam(m_db, stmt, ":val", nullptr);
+
+            if(m.fromaddr.has_value())
+                sql_bindparam(m_db, stmt, ":fromaddr", *m.fromaddr);
+            else
+                sql_bindparam(m_db, stmt, ":fromaddr", nullptr);
+
+            sql_step(m_db, stmt);
+            break;
+        }
+
+        case Mutation::SET_USERDATA: {
+            sqlite3_stmt* stmt =
+                this->prepare_query(SQLQueries::SET_USERDATA, R"(
+                INSERT INTO UserData
+                    VALUES (:k, :v)
+                ON CONFLICT DO 
+                    UPDATE SET v = EXCLUDED.v
+            )");
+
+            sql_bindparam(m_db, stmt, ":k", m.s);
+            sql_bindparam(m_db, stmt, ":v", m.value);
+            sql_step(m_db, stmt);
+            break;
+        }
+
+        default: ct_unreachable;
+    }
+}
+
 void Database::add_segment(std::string_view name, RDAddress startaddr,
                            RDAddress endaddr, u32 perm, u32 bits) {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::ADD_SEGMENT, R"(
         INSERT INTO Segments
             VALUES (:name, :startaddr, :endaddr, :perm, :bits)
@@ -223,6 +591,7 @@ void Database::add_segment(std::string_view name, RDAddress startaddr,
 }
 
 std::string Database::get_name(RDAddress address) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_NAME, R"(
         SELECT name 
         FROM Names 
@@ -238,20 +607,16 @@ std::string Database::get_name(RDAddress address) const {
 }
 
 void Database::add_ref(RDAddress fromaddr, RDAddress toaddr, usize type) {
-    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::ADD_REF, R"(
-        INSERT INTO Refs
-            VALUES (:fromaddr, :toaddr, :type)
-        ON CONFLICT DO 
-            UPDATE SET type = EXCLUDED.type
-    )");
-
-    sql_bindparam(m_db, stmt, ":fromaddr", fromaddr);
-    sql_bindparam(m_db, stmt, ":toaddr", toaddr);
-    sql_bindparam(m_db, stmt, ":type", type);
-    sql_step(m_db, stmt);
+    this->enqueue({
+        .kind = Mutation::ADD_REF,
+        .address = fromaddr,
+        .value = toaddr,
+        .n = type,
+    });
 }
 
 tl::optional<u64> Database::get_sreg(RDAddress addr, int reg) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_SREG, R"(
         SELECT value
         FROM SegmentRegisters
@@ -268,6 +633,7 @@ tl::optional<u64> Database::get_sreg(RDAddress addr, int reg) const {
 }
 
 Database::SRegChanges Database::get_sregs_from_addr(RDAddress addr) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt =
         this->prepare_query(SQLQueries::GET_SREGS_FROM_ADDR, R"(
         SELECT reg, value, fromaddr
@@ -293,6 +659,7 @@ Database::SRegChanges Database::get_sregs_from_addr(RDAddress addr) const {
 }
 
 Database::SRegChanges Database::get_sreg_changes(int sreg) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_SREG_CHANGES, R"(
         SELECT address, value, fromaddr
         FROM SegmentRegisters
@@ -317,6 +684,7 @@ Database::SRegChanges Database::get_sreg_changes(int sreg) const {
 }
 
 Database::SRegList Database::get_sregs() const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_SREGS, R"(
         SELECT DISTINCT reg
         FROM SegmentRegisters
@@ -332,44 +700,26 @@ Database::SRegList Database::get_sregs() const {
 
 void Database::set_sreg(RDAddress addr, int reg, const RDRegValue& val,
                         const tl::optional<RDAddress>& fromaddr) {
-    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_SREG, R"(
-        INSERT INTO SegmentRegisters (address, reg, value, fromaddr) 
-            VALUES (:address, :reg, :val, :fromaddr)
-        ON CONFLICT DO 
-            UPDATE SET reg = EXCLUDED.reg
-    )");
-
-    sql_bindparam(m_db, stmt, ":address", addr);
-    sql_bindparam(m_db, stmt, ":reg", reg);
-
-    if(val.ok)
-        sql_bindparam(m_db, stmt, ":val", val.value);
-    else
-        sql_bindparam(m_db, stmt, ":val", nullptr);
-
-    if(fromaddr.has_value())
-        sql_bindparam(m_db, stmt, ":fromaddr", *fromaddr);
-    else
-        sql_bindparam(m_db, stmt, ":fromaddr", nullptr);
-
-    sql_step(m_db, stmt);
+    this->enqueue({
+        .kind = Mutation::SET_SREG,
+        .address = addr,
+        .reg = reg,
+        .regval = val,
+        .fromaddr = fromaddr,
+    });
 }
 
 void Database::set_comment(RDAddress address, std::string_view comment) {
-    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_COMMENT, R"(
-        INSERT INTO Comments (address, comment) 
-            VALUES (:address, :comment)
-        ON CONFLICT DO 
-            UPDATE SET comment = EXCLUDED.comment
-    )");
-
-    sql_bindparam(m_db, stmt, ":address", address);
-    sql_bindparam(m_db, stmt, ":comment", comment);
-    sql_step(m_db, stmt);
+    this->enqueue({
+        .kind = Mutation::SET_COMMENT,
+        .address = address,
+        .s = std::string{comment},
+    });
 }
 
 Database::RefList Database::get_refs_from_type(RDAddress fromaddr,
                                                usize type) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_REFS_FROM_TYPE, R"(
         SELECT toaddr, type 
         FROM Refs
@@ -390,6 +740,7 @@ Database::RefList Database::get_refs_from_type(RDAddress fromaddr,
 }
 
 Database::RefList Database::get_refs_from(RDAddress fromaddr) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_REFS_FROM, R"(
         SELECT toaddr, type
         FROM Refs
@@ -410,6 +761,7 @@ Database::RefList Database::get_refs_from(RDAddress fromaddr) const {
 
 Database::RefList Database::get_refs_to_type(RDAddress toaddr,
                                              usize type) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_REFS_TO_TYPE, R"(
         SELECT fromaddr, type
         FROM Refs
@@ -430,6 +782,7 @@ Database::RefList Database::get_refs_to_type(RDAddress toaddr,
 }
 
 Database::RefList Database::get_refs_to(RDAddress toaddr) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_REFS_TO, R"(
         SELECT fromaddr, type 
         FROM Refs
@@ -449,49 +802,50 @@ Database::RefList Database::get_refs_to(RDAddress toaddr) const {
 }
 
 void Database::set_name(RDAddress address, std::string_view name) {
-    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_NAME, R"(
-        INSERT INTO Names
-            VALUES (:address, :name)
-        ON CONFLICT DO 
-            UPDATE SET name = EXCLUDED.name
-    )");
+    this->enqueue({
+        .kind = Mutation::SET_NAME,
+        .address = address,
+        .s = std::string{name},
+    });
+}
 
-    sql_bindparam(m_db, stmt, ":address", address);
-    sql_bindparam(m_db, stmt, ":name", name);
-    sql_step(m_db, stmt);
+void Database::set_names(const NameList& names) {
+    std::vector<Mutation> items;
+    items.reserve(names.size());
+
+    for(const auto& [address, name] : names) {
+        items.push_back({
+            .kind = Mutation::SET_NAME,
+            .address = address,
+            .s = name,
+        });
+    }
+
+    this->enqueue_batch(std::move(items));
 }
 
 void Database::set_type(RDAddress address, RDType t) {
-    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_TYPE, R"(
-        INSERT INTO Types
-            VALUES (:address, :name, :n)
-        ON CONFLICT DO 
-            UPDATE SET name = EXCLUDED.name, n = EXCLUDED.n
-    )");
-
     ct_assume(t.def);
 
-    sql_bindparam(m_db, stmt, ":address", address);
-    sql_bindparam(m_db, stmt, ":name", t.def->name);
-    sql_bindparam(m_db, stmt, ":n", t.n);
-    sql_step(m_db, stmt);
+    this->enqueue({
+        .kind = Mutation::SET_TYPE,
+        .address = address,
+        .n = t.n,
+        .s = t.def->name,
+    });
 }
 
 void Database::set_userdata(std::string_view k, uptr v) {
-    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::SET_USERDATA, R"(
-        INSERT INTO UserData
-            VALUES (:k, :v)
-        ON CONFLICT DO 
-            UPDATE SET v = EXCLUDED.v
-    )");
-
-    sql_bindparam(m_db, stmt, ":k", k);
-    sql_bindparam(m_db, stmt, ":v", v);
-    sql_step(m_db, stmt);
+    this->enqueue({
+        .kind = Mutation::SET_USERDATA,
+        .value = v,
+        .s = std::string{k},
+    });
 }
 
 tl::optional<uptr> Database::get_userdata(std::string_view k) const {
     if(k.empty()) return tl::nullopt;
+    auto lock = this->sync();
 
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_USERDATA, R"(
         SELECT v 
@@ -509,6 +863,7 @@ tl::optional<uptr> Database::get_userdata(std::string_view k) const {
 
 tl::optional<RDAddress> Database::get_address(std::string_view name) const {
     if(name.empty()) return tl::nullopt;
+    auto lock = this->sync();
 
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_INDEX, R"(
         SELECT address 
@@ -525,6 +880,7 @@ tl::optional<RDAddress> Database::get_address(std::string_view name) const {
 }
 
 std::string Database::get_comment(RDAddress address) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_COMMENT, R"(
         SELECT comment 
         FROM Comments 
@@ -539,7 +895,148 @@ std::string Database::get_comment(RDAddress address) const {
     return {};
 }
 
+Database::CommentList Database::get_comments() const {
+    auto lock = this->sync();
+
+    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_COMMENTS, R"(
+        SELECT address, comment
+        FROM Comments
+    )");
+
+    CommentList res;
+
+    while(sql_step(m_db, stmt) == SQLITE_ROW) {
+        res.emplace_back(
+            static_cast<RDAddress>(sqlite3_column_int64(stmt, 0)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+    }
+
+    return res;
+}
+
+Database::RangeRefList Database::get_refs_from_range(RDAddress start,
+                                                    RDAddress end) const {
+    auto lock = this->sync();
+    sqlite3_stmt* stmt =
+        this->prepare_query(SQLQueries::GET_REFS_FROM_RANGE, R"(
+        SELECT fromaddr, toaddr, type
+        FROM Refs
+        WHERE fromaddr BETWEEN :start AND :end
+    )");
+
+    sql_bindparam(m_db, stmt, ":start", start);
+    sql_bindparam(m_db, stmt, ":end", end);
+
+    RangeRefList res;
+
+    while(sql_step(m_db, stmt) == SQLITE_ROW) {
+        res.push_back({
+            .fromaddr = static_cast<RDAddress>(sqlite3_column_int64(stmt, 0)),
+            .toaddr = static_cast<RDAddress>(sqlite3_column_int64(stmt, 1)),
+            .type = static_cast<usize>(sqlite3_column_int64(stmt, 2)),
+        });
+    }
+
+    return res;
+}
+
+Database::RangeRefList Database::get_refs_to_range(RDAddress start,
+                                                  RDAddress end) const {
+    auto lock = this->sync();
+    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_REFS_TO_RANGE, R"(
+        SELECT fromaddr, toaddr, type
+        FROM Refs
+        WHERE toaddr BETWEEN :start AND :end
+    )");
+
+    sql_bindparam(m_db, stmt, ":start", start);
+    sql_bindparam(m_db, stmt, ":end", end);
+
+    RangeRefList res;
+
+    while(sql_step(m_db, stmt) == SQLITE_ROW) {
+        res.push_back({
+            .fromaddr = static_cast<RDAddress>(sqlite3_column_int64(stmt, 0)),
+            .toaddr = static_cast<RDAddress>(sqlite3_column_int64(stmt, 1)),
+            .type = static_cast<usize>(sqlite3_column_int64(stmt, 2)),
+        });
+    }
+
+    return res;
+}
+
+Database::CommentList Database::get_comments_range(RDAddress start,
+                                                   RDAddress end) const {
+    auto lock = this->sync();
+    sqlite3_stmt* stmt =
+        this->prepare_query(SQLQueries::GET_COMMENTS_RANGE, R"(
+        SELECT address, comment
+        FROM Comments
+        WHERE address BETWEEN :start AND :end
+    )");
+
+    sql_bindparam(m_db, stmt, ":start", start);
+    sql_bindparam(m_db, stmt, ":end", end);
+
+    CommentList res;
+
+    while(sql_step(m_db, stmt) == SQLITE_ROW) {
+        res.emplace_back(
+            static_cast<RDAddress>(sqlite3_column_int64(stmt, 0)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+    }
+
+    return res;
+}
+
+Database::NameList Database::get_names_range(RDAddress start,
+                                             RDAddress end) const {
+    auto lock = this->sync();
+    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_NAMES_RANGE, R"(
+        SELECT address, name
+        FROM Names
+        WHERE address BETWEEN :start AND :end
+    )");
+
+    sql_bindparam(m_db, stmt, ":start", start);
+    sql_bindparam(m_db, stmt, ":end", end);
+
+    NameList res;
+
+    while(sql_step(m_db, stmt) == SQLITE_ROW) {
+        res.emplace_back(
+            static_cast<RDAddress>(sqlite3_column_int64(stmt, 0)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+    }
+
+    return res;
+}
+
+Database::RangeRefList Database::get_refs_by_type(usize type) const {
+    auto lock = this->sync();
+    sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_REFS_BY_TYPE, R"(
+        SELECT fromaddr, toaddr, type
+        FROM Refs
+        WHERE type = :type
+    )");
+
+    sql_bindparam(m_db, stmt, ":type", type);
+
+    RangeRefList res;
+
+    while(sql_step(m_db, stmt) == SQLITE_ROW) {
+        res.push_back({
+            .fromaddr = static_cast<RDAddress>(sqlite3_column_int64(stmt, 0)),
+            .toaddr = static_cast<RDAddress>(sqlite3_column_int64(stmt, 1)),
+            .type = static_cast<usize>(sqlite3_column_int64(stmt, 2)),
+        });
+    }
+
+    return res;
+}
+
 tl::optional<Database::Type> Database::get_type(RDAddress address) const {
+    auto lock = this->sync();
     sqlite3_stmt* stmt = this->prepare_query(SQLQueries::GET_COMMENT, R"(
         SELECT name,n
         FROM Types
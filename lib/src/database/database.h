@@ -2,9 +2,12 @@
 
 #include <redasm/redasm.h>
 #include <redasm/typing.h>
+#include <atomic>
+#include <mutex>
 #include <sqlite3.h>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <tl/optional.hpp>
 
 namespace redasm {
@@ -23,13 +26,51 @@ public:
         usize n;
     };
 
+    struct RangeRef {
+        RDAddress fromaddr;
+        RDAddress toaddr;
+        usize type;
+    };
+
     using RefList = std::vector<RDRef>;
+    using RangeRefList = std::vector<RangeRef>;
+    using CommentList = std::vector<std::pair<RDAddress, std::string>>;
+    using NameList = std::vector<std::pair<RDAddress, std::string>>;
     using SRegChanges = std::vector<SegmentReg>;
     using SRegList = std::vector<int>;
 
+private:
+    // Pending write, applied by the writer thread in async mode
+    struct Mutation {
+        enum Kind {
+            ADD_REF = 0,
+            SET_COMMENT,
+            SET_NAME,
+            SET_TYPE,
+            SET_SREG,
+            SET_USERDATA,
+        };
+
+        Kind kind;
+        RDAddress address;
+        u64 value;
+        usize n;
+        int reg;
+        RDRegValue regval;
+        tl::optional<RDAddress> fromaddr;
+        std::string s;
+        Mutation* next{nullptr};
+    };
+
 public:
-    explicit Database(std::string_view ldrid, std::string_view source);
+    explicit Database(std::string_view ldrid, std::string_view source,
+                      usize flags = 0);
     ~Database();
+    void flush() const;
+    RDDatabaseMetrics get_metrics() const;
+    std::string serialize() const;
+    bool save(std::string_view filepath) const;
+    bool deserialize(std::string_view data);
 
 public:
     RefList get_refs_from_type(RDAddress fromaddr, usize type) const;
@@ -38,9 +79,18 @@ public:
     RefList get_refs_to(RDAddress toaddr) const;
     std::string get_name(RDAddress address) const;
     std::string get_comment(RDAddress address) const;
+    CommentList get_comments() const;
+
+    // Range queries, both bounds are inclusive
+    RangeRefList get_refs_from_range(RDAddress start, RDAddress end) const;
+    RangeRefList get_refs_to_range(RDAddress start, RDAddress end) const;
+    CommentList get_comments_range(RDAddress start, RDAddress end) const;
+    NameList get_names_range(RDAddress start, RDAddress end) const;
+    RangeRefList get_refs_by_type(usize type) const;
     void add_ref(RDAddress fromaddr, RDAddress toaddr, usize type);
     void set_comment(RDAddress address, std::string_view comment);
     void set_name(RDAddress address, std::string_view name);
+    void set_names(const NameList& names);
     void set_type(RDAddress address, RDType t);
     void set_userdata(std::string_view k, uptr v);
     tl::optional<uptr> get_userdata(std::string_view k) const;
@@ -61,11 +111,33 @@ public:
 
 private:
     sqlite3_stmt* prepare_query(int q, std::string_view s) const;
+    std::unique_lock<std::mutex> sync() const;
+    void enqueue(Mutation m);
+    void enqueue_batch(std::vector<Mutation> items);
+    void apply(const Mutation& m);
+    void apply_batch(Mutation* head);
+    void writer_loop();
 
 private:
     sqlite3* m_db{nullptr};
     mutable std::unordered_map<int, sqlite3_stmt*> m_queries;
     std::string m_dbname, m_dbroot;
+
+    // Guards m_db and m_queries, in every mode
+    mutable std::mutex m_dbmutex;
+
+    // Async writer state
+    std::thread m_writer;
+    std::atomic<Mutation*> m_pending{nullptr};
+    mutable std::atomic<u64> m_enqueued{0};
+    mutable std::atomic<u64> m_applied{0};
+    std::atomic<bool> m_stop{false};
+
+    // Metrics
+    std::atomic<usize> m_highwatermark{0};
+    std::atomic<usize> m_nbatches{0};
+    std::atomic<u64> m_lastflushus{0};
+    std::atomic<u64> m_maxflushus{0};
 };
 
 } // namespace redasm
@@ -0,0 +1,610 @@
+#include "snapshot.h"
+#include "../context.h"
+#include "../disasm/memprocess.h"
+#include "../state.h"
+#include "../utils/msgpack.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <miniz.h>
+#include <spdlog/spdlog.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_USE_MMAP
+#endif
+
+namespace redasm::snapshot {
+
+namespace {
+
+// Layout:
+//   Header | ChunkEntry[nchunks] | (padding) | Chunk #0 | (padding) | ...
+//
+// Every chunk starts at a page aligned offset, MByte arrays are never
+// compressed: they can be copied (or mapped) straight from the file.
+
+constexpr std::array<char, 8> SNAPSHOT_MAGIC = {'R', 'D', 'S', 'N',
+                                                'A', 'P', '\0', '\0'};
+constexpr u32 SNAPSHOT_VERSION = 1;
+constexpr usize SNAPSHOT_ALIGN = 4096;
+
+constexpr u32 make_chunkid(const char (&id)[5]) {
+    return static_cast<u32>(id[0]) | (static_cast<u32>(id[1]) << 8) |
+           (static_cast<u32>(id[2]) << 16) | (static_cast<u32>(id[3]) << 24);
+}
+
+enum ChunkId : u32 {
+    CHUNK_META = make_chunkid("META"),
+    CHUNK_SEGMENTS = make_chunkid("SEGS"),
+    CHUNK_MBYTES = make_chunkid("MBYT"),
+    CHUNK_SREGS = make_chunkid("SREG"),
+    CHUNK_FUNCTIONS = make_chunkid("FUNC"),
+    CHUNK_DATABASE = make_chunkid("SQLD"),
+};
+
+enum ChunkFlags : u32 {
+    CF_COMPRESSED = 1 << 0,
+};
+
+struct Header {
+    std::array<char, 8> magic;
+    u32 version;
+    u32 nchunks;
+};
+
+struct ChunkEntry {
+    u32 id;
+    u32 flags;
+    u64 offset;
+    u64 size;
+    u64 rawsize;
+};
+
+static_assert(sizeof(Header) == 16);
+static_assert(sizeof(ChunkEntry) == 32);
+
+struct Chunk {
+    u32 id;
+    u32 flags{0};
+    std::string data;      // Owned chunk data (if any)
+    std::string_view view; // Bytes written to file
+    usize rawsize{0};
+};
+
+class MappedFile {
+public:
+    explicit MappedFile(std::string_view filepath) {
+        std::string fp{filepath};
+
+#if defined(SNAPSHOT_USE_MMAP)
+        int fd = ::open(fp.c_str(), O_RDONLY);
+        if(fd == -1) return;
+
+        struct stat st {};
+
+        if(!::fstat(fd, &st) && st.st_size > 0) {
+            void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if(p != MAP_FAILED) {
+                m_data = static_cast<const char*>(p);
+                m_size = st.st_size;
+            }
+        }
+
+        ::close(fd);
+#else
+        std::ifstream ifs(fp, std::ios::binary | std::ios::ate);
+        if(!ifs.is_open()) return;
+
+        m_buffer.resize(ifs.tellg());
+        ifs.seekg(0);
+        ifs.read(m_buffer.data(), m_buffer.size());
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+#endif
+    }
+
+    ~MappedFile() {
+#if defined(SNAPSHOT_USE_MMAP)
+        if(m_data) ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool is_open() const { return m_data != nullptr; }
+
+    [[nodiscard]] tl::optional<std::string_view> view(usize off,
+                                                      usize n) const {
+        if(off > m_size || n > m_size - off) return tl::nullopt;
+        return std::string_view{m_data + off, n};
+    }
+
+private:
+#if !defined(SNAPSHOT_USE_MMAP)
+    std::string m_buffer;
+#endif
+    const char* m_data{nullptr};
+    usize m_size{0};
+};
+
+usize align_up(usize n) {
+    return (n + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1);
+}
+
+Chunk make_chunk(u32 id, std::string data, bool compress) {
+    Chunk c{.id = id, .data = std::move(data)};
+    c.rawsize = c.data.size();
+
+    if(compress && !c.data.empty()) {
+        mz_ulong n = mz_compressBound(c.data.size());
+        std::string res(n, '\0');
+
+        if(mz_compress2(reinterpret_cast<u8*>(res.data()), &n,
+                        reinterpret_cast<const u8*>(c.data.data()),
+                        c.data.size(), MZ_BEST_SPEED) == MZ_OK &&
+           n < c.data.size()) {
+            res.resize(n);
+            c.data = std::move(res);
+            c.flags |= CF_COMPRESSED;
+        }
+    }
+
+    c.view = c.data;
+    return c;
+}
+
+tl::optional<std::string> read_chunk(const MappedFile& mf,
+                                     const ChunkEntry& e) {
+    auto v = mf.view(e.offset, e.size);
+    if(!v) return tl::nullopt;
+    if(!(e.flags & CF_COMPRESSED)) return std::string{*v};
+
+    std::string res(e.rawsize, '\0');
+    mz_ulong n = e.rawsize;
+
+    if(mz_uncompress(reinterpret_cast<u8*>(res.data()), &n,
+                     reinterpret_cast<const u8*>(v->data()),
+                     v->size()) != MZ_OK ||
+       n != e.rawsize)
+        return tl::nullopt;
+
+    return res;
+}
+
+std::string pack_meta(const Context* ctx) {
+    std::string buf;
+    msgpack::MsgPack mp{buf};
+    mp.pack(std::string_view{ctx->loaderplugin->id});
+    mp.pack(std::string_view{ctx->processorplugin->id});
+    mp.pack(static_cast<u64>(ctx->program.file->length));
+    mp.pack(ctx->entrypoint.has_value());
+    mp.pack(static_cast<u64>(ctx->entrypoint.value_or(0)));
+    return buf;
+}
+
+std::string pack_segments(const Context* ctx) {
+    std::string buf;
+    msgpack::MsgPack mp{buf};
+    mp.pack_array(slice_length(&ctx->program.segments));
+
+    const RDSegment* seg;
+    slice_foreach(seg, &ctx->program.segments) {
+        mp.pack(std::string_view{seg->name});
+        mp.pack(static_cast<u64>(seg->start));
+        mp.pack(static_cast<u64>(seg->end));
+        mp.pack(seg->perm);
+        mp.pack(seg->bits);
+    }
+
+    mp.pack_array(ctx->program.mappings.size());
+
+    for(const FileMapping& m : ctx->program.mappings) {
+        mp.pack(static_cast<u64>(m.base));
+        mp.pack(static_cast<u64>(m.length));
+        mp.pack(static_cast<u64>(m.offset));
+    }
+
+    return buf;
+}
+
+std::string pack_sregs(const Context* ctx) {
+    std::vector<const RDSRange*> ranges;
+    std::vector<int> regs;
+
+    const RDSRegTree* regit;
+    hmap_foreach(regit, &ctx->program.segmentregs, RDSRegTree, hnode) {
+        const RDSRange* rangeit;
+        rbtree_foreach(rangeit, &regit->root, RDSRange, rbnode) {
+            ranges.push_back(rangeit);
+            regs.push_back(regit->sreg);
+        }
+    }
+
+    std::string buf;
+    msgpack::MsgPack mp{buf};
+    mp.pack_array(ranges.size());
+
+    for(usize i = 0; i < ranges.size(); i++) {
+        mp.pack(regs[i]);
+        mp.pack(static_cast<u64>(ranges[i]->start));
+        mp.pack(static_cast<u64>(ranges[i]->end));
+        mp.pack(ranges[i]->val.ok);
+        mp.pack(static_cast<u64>(ranges[i]->val.value));
+    }
+
+    return buf;
+}
+
+std::string pack_functions(const Context* ctx) {
+    std::string buf;
+    msgpack::MsgPack mp{buf};
+    mp.pack_array(ctx->program.functions.size());
+
+    for(const Function& f : ctx->program.functions) {
+        std::unordered_map<RDGraphNode, usize> nodeidx;
+
+        mp.pack(static_cast<u64>(f.address));
+        mp.pack(static_cast<u64>(f.framesize));
+        mp.pack_array(f.blocks.size());
+
+        for(usize i = 0; i < f.blocks.size(); i++) {
+            const Function::BasicBlock& bb = f.blocks[i];
+            nodeidx[bb.node] = i;
+            mp.pack(static_cast<u64>(bb.start));
+            mp.pack(static_cast<u64>(bb.end));
+        }
+
+        auto root = nodeidx.find(f.graph.root());
+        mp.pack(static_cast<u64>(root != nodeidx.end() ? root->second : 0));
+
+        const Graph::Edges& edges = f.graph.edges();
+        mp.pack_array(edges.size());
+
+        for(const RDGraphEdge& e : edges) {
+            mp.pack(static_cast<u64>(nodeidx.at(e.src)));
+            mp.pack(static_cast<u64>(nodeidx.at(e.dst)));
+            mp.pack(static_cast<int>(f.get_theme(e)));
+        }
+    }
+
+    return buf;
+}
+
+bool check_meta(const Context* ctx, std::string& data) {
+    msgpack::MsgPack mp{data};
+
+    auto loaderid = mp.unpack<std::string>();
+    auto processorid = mp.unpack<std::string>();
+    auto filelength = mp.unpack<u64>();
+
+    if(loaderid != ctx->loaderplugin->id ||
+       processorid != ctx->processorplugin->id ||
+       filelength != ctx->program.file->length) {
+        spdlog::error("Snapshot: loader, processor or file mismatch");
+        return false;
+    }
+
+    return true;
+}
+
+bool check_segments(Context* ctx, std::string& data) {
+    msgpack::MsgPack mp{data};
+    usize n = mp.unpack_array();
+
+    if(n != slice_length(&ctx->program.segments)) {
+        spdlog::error("Snapshot: segment count mismatch");
+        return false;
+    }
+
+    for(usize i = 0; i < n; i++) {
+        const RDSegment& seg = slice_at(&ctx->program.segments, i);
+        auto name = mp.unpack<std::string>();
+        auto start = mp.unpack<u64>();
+        auto end = mp.unpack<u64>();
+        mp.unpack<u32>(); // perm
+        mp.unpack<u32>(); // bits
+
+        if(name != seg.name || start != seg.start || end != seg.end) {
+            spdlog::error("Snapshot: segment '{}' mismatch", name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Chunks are decoded into temporaries first: msgpack throws on malformed
+// data and the context is only written when every chunk is valid
+struct SRegRange {
+    int sreg;
+    RDAddress start, end;
+    bool ok;
+    u64 value;
+};
+
+struct Restore {
+    tl::optional<RDAddress> entrypoint;
+    std::vector<FileMapping> mappings;
+    std::vector<SRegRange> sregs;
+    std::vector<Function> functions;
+};
+
+void decode_meta(Restore& r, std::string& data) {
+    msgpack::MsgPack mp{data};
+    mp.unpack<std::string>();
+    mp.unpack<std::string>();
+    mp.unpack<u64>();
+
+    bool hasep = mp.unpack<bool>();
+    auto ep = mp.unpack<u64>();
+    if(hasep) r.entrypoint = ep;
+}
+
+void decode_mappings(Restore& r, std::string& data) {
+    msgpack::MsgPack mp{data};
+    usize n = mp.unpack_array();
+
+    for(usize i = 0; i < n; i++) {
+        mp.unpack<std::string>();
+        mp.unpack<u64>();
+        mp.unpack<u64>();
+        mp.unpack<u32>();
+        mp.unpack<u32>();
+    }
+
+    n = mp.unpack_array();
+    r.mappings.reserve(n);
+
+    for(usize i = 0; i < n; i++) {
+        auto base = mp.unpack<u64>();
+        auto length = mp.unpack<u64>();
+        auto offset = mp.unpack<u64>();
+
+        r.mappings.push_back({
+            .base = base,
+            .length = length,
+            .offset = offset,
+        });
+    }
+}
+
+void decode_sregs(Restore& r, std::string& data) {
+    msgpack::MsgPack mp{data};
+    usize n = mp.unpack_array();
+    r.sregs.reserve(n);
+
+    for(usize i = 0; i < n; i++) {
+        SRegRange& sr = r.sregs.emplace_back();
+        sr.sreg = mp.unpack<int>();
+        sr.start = mp.unpack<u64>();
+        sr.end = mp.unpack<u64>();
+        sr.ok = mp.unpack<bool>();
+        sr.value = mp.unpack<u64>();
+    }
+}
+
+void decode_functions(Restore& r, std::string& data) {
+    msgpack::MsgPack mp{data};
+    usize n = mp.unpack_array();
+    r.functions.reserve(n);
+
+    for(usize i = 0; i < n; i++) {
+        Function& f = r.functions.emplace_back(mp.unpack<u64>());
+        f.framesize = mp.unpack<u64>();
+
+        usize nblocks = mp.unpack_array();
+        std::vector<RDGraphNode> nodes;
+        nodes.reserve(nblocks);
+
+        for(usize j = 0; j < nblocks; j++) {
+            RDGraphNode node = f.try_add_block(mp.unpack<u64>());
+            f.get_basic_block(node)->end = mp.unpack<u64>();
+            nodes.push_back(node);
+        }
+
+        auto root = mp.unpack<u64>();
+        if(root < nodes.size()) f.graph.set_root(nodes[root]);
+
+        usize nedges = mp.unpack_array();
+
+        for(usize j = 0; j < nedges; j++) {
+            auto src = mp.unpack<u64>();
+            auto dst = mp.unpack<u64>();
+            auto theme = static_cast<RDThemeKind>(mp.unpack<int>());
+            if(src < nodes.size() && dst < nodes.size())
+                f.jmp(nodes[src], nodes[dst], theme);
+        }
+
+        f.finalize();
+    }
+}
+
+void commit(Context* ctx, Restore& r) {
+    if(r.entrypoint) ctx->entrypoint = r.entrypoint;
+    ctx->program.mappings = std::move(r.mappings);
+    ctx->program.clear_sregs();
+
+    for(const SRegRange& sr : r.sregs) {
+        ctx->program.add_sreg_range(sr.start, sr.end, sr.sreg, sr.value);
+        if(!sr.ok) ctx->program.set_sreg(sr.start, sr.sreg, RDRegValue_none());
+    }
+
+    ctx->program.set_functions(std::move(r.functions));
+}
+
+} // namespace
+
+bool save(std::string_view filepath, usize flags) {
+    Context* ctx = state::context;
+    if(!ctx || !ctx->get_database()) return false;
+
+    bool compress = flags & SNAP_COMPRESS;
+    std::vector<Chunk> chunks;
+
+    chunks.push_back(make_chunk(CHUNK_META, pack_meta(ctx), false));
+    chunks.push_back(make_chunk(CHUNK_SEGMENTS, pack_segments(ctx), compress));
+
+    const RDSegment* seg;
+    slice_foreach(seg, &ctx->program.segments) {
+        usize n = seg->mem->length * sizeof(RDMByte);
+
+        chunks.push_back({
+            .id = CHUNK_MBYTES,
+            .view = {reinterpret_cast<const char*>(seg->mem->m_data), n},
+            .rawsize = n,
+        });
+    }
+
+    chunks.push_back(make_chunk(CHUNK_SREGS, pack_sregs(ctx), compress));
+    chunks.push_back(
+        make_chunk(CHUNK_FUNCTIONS, pack_functions(ctx), compress));
+    chunks.push_back(make_chunk(
+        CHUNK_DATABASE, ctx->get_database()->serialize(), compress));
+
+    Header h = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .nchunks = static_cast<u32>(chunks.size()),
+    };
+
+    std::vector<ChunkEntry> entries;
+    usize offset = align_up(sizeof(Header) + chunks.size() * sizeof(ChunkEntry));
+
+    for(const Chunk& c : chunks) {
+        entries.push_back({
+            .id = c.id,
+            .flags = c.flags,
+            .offset = offset,
+            .size = c.view.size(),
+            .rawsize = c.rawsize,
+        });
+
+        offset = align_up(offset + c.view.size());
+    }
+
+    std::ofstream ofs{std::string{filepath}, std::ios::binary | std::ios::trunc};
+
+    if(!ofs.is_open()) {
+        spdlog::error("Snapshot: cannot write '{}'", filepath);
+        return false;
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&h), sizeof(Header));
+    ofs.write(reinterpret_cast<const char*>(entries.data()),
+              entries.size() * sizeof(ChunkEntry));
+
+    for(usize i = 0; i < chunks.size(); i++) {
+        ofs.seekp(entries[i].offset);
+        ofs.write(chunks[i].view.data(), chunks[i].view.size());
+    }
+
+    // Pad the last chunk
+    if(static_cast<usize>(ofs.tellp()) < offset) {
+        ofs.seekp(offset - 1);
+        ofs.put('\0');
+    }
+
+    spdlog::info("Snapshot: saved '{}' ({} chunks)", filepath, chunks.size());
+    return ofs.good();
+}
+
+bool load(std::string_view filepath) {
+    Context* ctx = state::context;
+    if(!ctx || !ctx->get_database()) return false;
+
+    MappedFile mf{filepath};
+
+    if(!mf.is_open()) {
+        spdlog::error("Snapshot: cannot open '{}'", filepath);
+        return false;
+    }
+
+    Header h;
+    auto hv = mf.view(0, sizeof(Header));
+    if(hv) std::memcpy(&h, hv->data(), sizeof(Header));
+
+    if(!hv || h.magic != SNAPSHOT_MAGIC || h.version != SNAPSHOT_VERSION) {
+        spdlog::error("Snapshot: invalid file '{}'", filepath);
+        return false;
+    }
+
+    auto ev = mf.view(sizeof(Header), h.nchunks * sizeof(ChunkEntry));
+    if(!ev) return false;
+
+    std::vector<ChunkEntry> entries(h.nchunks);
+    std::memcpy(entries.data(), ev->data(), ev->size());
+
+    std::unordered_map<u32, std::string> chunks;
+    std::vector<std::string_view> mbytes;
+
+    for(const ChunkEntry& e : entries) {
+        if(e.id == CHUNK_MBYTES) {
+            auto v = mf.view(e.offset, e.size);
+            if(!v) return false;
+            mbytes.push_back(*v);
+        }
+        else if(auto c = read_chunk(mf, e); c)
+            chunks[e.id] = std::move(*c);
+        else {
+            spdlog::error("Snapshot: corrupted chunk");
+            return false;
+        }
+    }
+
+    for(u32 id : {CHUNK_META, CHUNK_SEGMENTS, CHUNK_SREGS, CHUNK_FUNCTIONS,
+                  CHUNK_DATABASE}) {
+        if(!chunks.contains(id)) {
+            spdlog::error("Snapshot: missing chunk");
+            return false;
+        }
+    }
+
+    try {
+        if(!check_meta(ctx, chunks[CHUNK_META]) ||
+           !check_segments(ctx, chunks[CHUNK_SEGMENTS]))
+            return false;
+
+        if(mbytes.size() != slice_length(&ctx->program.segments))
+            return false;
+
+        for(usize i = 0; i < mbytes.size(); i++) {
+            const RDSegment& seg = slice_at(&ctx->program.segments, i);
+            if(mbytes[i].size() != seg.mem->length * sizeof(RDMByte))
+                return false;
+        }
+
+        Restore r;
+        decode_meta(r, chunks[CHUNK_META]);
+        decode_mappings(r, chunks[CHUNK_SEGMENTS]);
+        decode_sregs(r, chunks[CHUNK_SREGS]);
+        decode_functions(r, chunks[CHUNK_FUNCTIONS]);
+
+        if(!ctx->get_database()->deserialize(chunks[CHUNK_DATABASE]))
+            return false;
+
+        for(usize i = 0; i < mbytes.size(); i++) {
+            const RDSegment& seg = slice_at(&ctx->program.segments, i);
+            std::memcpy(seg.mem->m_data, mbytes[i].data(), mbytes[i].size());
+        }
+
+        commit(ctx, r);
+    }
+    catch(const std::exception& e) {
+        spdlog::error("Snapshot: {}", e.what());
+        return false;
+    }
+
+    // Functions come from the snapshot, don't rebuild them from flags
+    ctx->worker->complete();
+    memprocess::process_listing(false);
+    spdlog::info("Snapshot: loaded '{}'", filepath);
+    return true;
+}
+
+} // namespace redasm::snapshot
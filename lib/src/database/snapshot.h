@@ -0,0 +1,11 @@
+#pragma once
+
+#include <redasm/types.h>
+#include <string_view>
+
+namespace redasm::snapshot {
+
+bool save(std::string_view filepath, usize flags);
+bool load(std::string_view filepath);
+
+} // namespace redasm::snapshot
@@ -149,6 +149,10 @@ u32 Emulator::tick() {
         plugin->emulate(ctx->processor, api::to_c(this), &instr);
         memory::set_n(this->segment, this->pc, instr.length, BF_CODE);
 
+        // Jumps are indexed once their destination is code
+        if(memory::has_flag(this->segment, this->pc, BF_JUMPDST))
+            ctx->invalidate_jumps();
+
         if(instr.features & IF_JUMP)
             memory::set_flag(this->segment, this->pc, BF_JUMP);
         if(instr.features & IF_CALL)
@@ -170,9 +174,8 @@ void Emulator::execute_delayslots(const RDInstruction& instr) {
         u32 len = this->tick();
 
         if(!len) {
-            state::context->add_problem(
-                this->pc,
-                fmt::format("Cannot decode delay slot #{}", this->ndslot));
+            state::context->add_problem(this->pc, PROBLEM_DELAY_SLOT,
+                                        this->ndslot);
             break;
         }
     }
@@ -202,9 +205,8 @@ bool Emulator::decode(RDAddress address, RDInstruction& instr) {
     if(plugin->decode)
         plugin->decode(state::context->processor, &instr);
     else {
-        state::context->add_problem(
-            address, fmt::format("decode() not implemented for processor '{}'",
-                                 plugin->name));
+        state::context->add_problem(address, PROBLEM_DECODE_NOT_IMPLEMENTED,
+                                    0, plugin->name);
         return false;
     }
 
@@ -3,51 +3,68 @@
 
 namespace redasm {
 
-Function::Function(RDAddress ep): address{ep} {}
+Function::Function(RDAddress ep): address{ep} { this->graph.set_address(ep); }
 
 bool Function::contains(RDAddress address) const {
-    return std::any_of(this->blocks.begin(), this->blocks.end(),
-                       [address](const BasicBlock& x) {
-                           return address >= x.start && address <= x.end;
-                       });
+    // Not finalized yet, blocks are still being discovered
+    if(m_maxend.size() != this->blocks.size()) {
+        return std::ranges::any_of(this->blocks, [address](const auto& x) {
+            return address >= x.start && address <= x.end;
+        });
+    }
+
+    // Last block starting at or before 'address': any block up to it
+    // reaching 'address' contains it
+    auto it = std::ranges::upper_bound(this->blocks, address, {},
+                                       [](const auto& x) { return x.start; });
+
+    if(it == this->blocks.begin()) return false;
+    return m_maxend[std::distance(this->blocks.begin(), it) - 1] >= address;
 }
 
 RDGraphNode Function::try_add_block(RDAddress start) {
-    for(const BasicBlock& bb : this->blocks) {
-        if(bb.start == start) return bb.node;
-    }
+    auto it = m_blockstarts.find(start);
+    if(it != m_blockstarts.end()) return it->second;
+
+    RDGraphNode n = this->graph.add_node();
+    ct_assume(n);
 
-    auto it = std::lower_bound(
-        this->blocks.begin(), this->blocks.end(), start,
-        [](const BasicBlock& a, RDAddress b) { return a.start < b; });
+    if(m_nodeblocks.size() < n) m_nodeblocks.resize(n);
+    m_nodeblocks[n - 1] = this->blocks.size();
+    m_blockstarts[start] = n;
+    m_maxend.clear();
 
-    return this->blocks.emplace(it, this->graph.add_node(), start)->node;
+    this->blocks.emplace_back(n, start);
+    return n;
 }
 
 Function::BasicBlock* Function::get_basic_block(RDGraphNode n) {
-    for(BasicBlock& bb : this->blocks) {
-        if(bb.node == n) return &bb;
-    }
-
-    return nullptr;
+    if(!n || n > m_nodeblocks.size()) return nullptr;
+    return &this->blocks[m_nodeblocks[n - 1]];
 }
 
 RDThemeKind Function::get_theme(const RDGraphEdge& e) const {
-    const BasicBlock* bb = this->get_basic_block(e.src);
+    auto it = m_themes.find(e);
+    return it != m_themes.end() ? it->second : THEME_DEFAULT;
+}
 
-    if(bb) {
-        for(const auto& [dst, theme] : bb->theme) {
-            if(e.dst == dst) return theme;
-        }
-    }
+void Function::finalize() {
+    std::ranges::sort(this->blocks, {}, [](const auto& x) { return x.start; });
 
-    return THEME_DEFAULT;
+    m_maxend.resize(this->blocks.size());
+    RDAddress maxend = 0;
+
+    for(usize i = 0; i < this->blocks.size(); i++) {
+        const BasicBlock& bb = this->blocks[i];
+        m_nodeblocks[bb.node - 1] = i;
+        maxend = std::max(maxend, bb.end);
+        m_maxend[i] = maxend;
+    }
 }
 
 void Function::jmp(RDGraphNode src, RDGraphNode dst, RDThemeKind theme) {
-    BasicBlock* bb = this->get_basic_block(src);
-    ct_assume(bb);
-    bb->theme[dst] = theme;
+    ct_assume(this->get_basic_block(src));
+    m_themes[{src, dst}] = theme;
     this->graph.add_edge(src, dst);
 }
 
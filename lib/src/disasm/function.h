@@ -3,6 +3,7 @@
 #include "../graph/styledgraph.h"
 #include <redasm/function.h>
 #include <redasm/theme.h>
+#include <unordered_map>
 #include <vector>
 
 namespace redasm {
@@ -15,7 +16,6 @@ struct Function {
         }
 
         RDGraphNode node;
-        std::unordered_map<RDGraphNode, RDThemeKind> theme;
     };
 
     using Blocks = std::vector<BasicBlock>;
@@ -26,6 +26,10 @@ struct Function {
     BasicBlock* get_basic_block(RDGraphNode n);
     RDThemeKind get_theme(const RDGraphEdge& e) const;
 
+    // Sorts 'blocks' by address and builds the lookup index for contains(),
+    // must be called once every block has its final range
+    void finalize();
+
     void jmp(RDGraphNode src, RDGraphNode dst,
              RDThemeKind theme = THEME_DEFAULT);
 
@@ -43,10 +47,16 @@ struct Function {
 
     RDAddress address;
     StyledGraph graph;
-    Blocks blocks;
+    Blocks blocks; // Sorted by start address after finalize()
 
     // Stack Information
     u64 framesize;
+
+private:
+    std::vector<usize> m_nodeblocks; // Node id -> 'blocks' index
+    std::unordered_map<RDAddress, RDGraphNode> m_blockstarts;
+    std::unordered_map<RDGraphEdge, RDThemeKind> m_themes;
+    std::vector<RDAddress> m_maxend; // Prefix maximum of block ends
 };
 
 } // namespace redasm
@@ -5,9 +5,11 @@
 #include "../memory/memory.h"
 #include "../memory/stringfinder.h"
 #include "../state.h"
+#include "../utils/parallel.h"
 #include "../utils/pattern.h"
 #include "../utils/utils.h"
 #include "function.h"
+#include <algorithm>
 #include <unordered_set>
 
 namespace redasm::memprocess {
@@ -17,29 +19,48 @@ namespace {
 void process_listing_array(const Context* ctx, Listing& l, RDAddress& address,
                            RDType t);
 
-template<typename Function>
-void process_hexdump(Listing& l, RDAddress& address, Function f) {
+constexpr usize HEXDUMP_SIZE = 0x10;
+
+// Flags are scanned in place, no per byte lookups
+const RDMByte* get_mbytes(const RDSegment* seg, RDAddress address) {
+    ct_assume(seg->mem);
+    return seg->mem->m_data + (address - seg->start);
+}
+
+usize get_fill_length(const RDSegment* seg, RDAddress address) {
+    const RDMByte* first = memprocess::get_mbytes(seg, address);
+    const RDMByte* last = first + (seg->end - address);
+    const RDMByte* it = std::find_if(
+        first, last, [](RDMByte b) { return mbyte::is_end(b); });
+
+    if(it == last) return 0;
+    return std::distance(first, it) + 1;
+}
+
+void process_listing_unknown(Listing& l, RDAddress& address, RDAddress end) {
     const RDSegment* seg = l.current_segment();
     ct_assume(seg);
 
-    RDAddress start = address;
-    usize len = 0;
+    const RDMByte* first = memprocess::get_mbytes(seg, address);
+    const RDMByte* last = std::find_if_not(
+        first, first + (end - address),
+        [](RDMByte b) { return mbyte::is_unknown(b); });
 
-    for(; address < seg->end && f(seg, address); len++, address++) {
-        if(len && !(len % 0x10)) {
-            l.hex_dump(start, address);
-            start = address;
-        }
+    RDAddress endaddr = address + std::distance(first, last);
+
+    // Skeletons only need the number of rows
+    if(l.is_counting()) {
+        l.count_rows((endaddr - address + HEXDUMP_SIZE - 1) / HEXDUMP_SIZE);
+        address = endaddr;
+        return;
     }
 
-    if(address > start) l.hex_dump(start, address);
-}
+    for(; address < endaddr; address += HEXDUMP_SIZE) {
+        l.hex_dump(address,
+                   std::min<RDAddress>(address + HEXDUMP_SIZE, endaddr));
+    }
 
-void process_listing_unknown(Listing& l, RDAddress& address) {
-    memprocess::process_hexdump(l, address,
-                                [](const RDSegment* seg, RDAddress addr) {
-                                    return memory::is_unknown(seg, addr);
-                                });
+    address = endaddr;
 }
 
 LIndex process_listing_type(const Context* ctx, Listing& l, RDAddress& address,
@@ -154,7 +175,7 @@ void process_listing_array(const Context* ctx, Listing& l, RDAddress& address,
         for(usize i = 0; i < std::max<usize>(t.n, 1); i++) {
             LIndex lidx =
                 memprocess::process_listing_type(ctx, l, address, *itemtype);
-            l[lidx].array_index = i;
+            l.set_array_index(lidx, i);
         }
     }
 
@@ -175,7 +196,7 @@ void process_listing_data(const Context* ctx, Listing& l, RDAddress& address) {
             memprocess::process_listing_type(ctx, l, address, *type);
     }
     else if(memory::has_flag(seg, address, BF_FILL)) {
-        usize len = memory::get_length(seg, address);
+        usize len = memprocess::get_fill_length(seg, address);
         if(len <= 1) ct_exceptf("Invalid length @ %x (FILL)", address);
         l.fill(address, address + len);
         address += len;
@@ -215,7 +236,7 @@ void process_unknown_data(Context* ctx, RDSegment* seg, RDAddress& address) {
 void process_function_graph(const Context* ctx,
                             std::vector<Function>& functions,
                             RDAddress address) {
-    spdlog::info("Creating function graph @ {:x}", address);
+    spdlog::trace("Creating function graph @ {:x}", address);
 
     Function& f = functions.emplace_back(address);
     std::unordered_set<RDAddress> done;
@@ -304,10 +325,12 @@ void process_function_graph(const Context* ctx,
         ct_assume(bb);
         bb->end = std::min<RDAddress>(endaddr, seg->end - 1);
     }
+
+    f.finalize();
 }
 
 void process_listing_code(const Context* ctx, Listing& l,
-                          std::vector<Function>& functions,
+                          std::vector<Function>* functions,
                           RDAddress& address) {
     const RDSegment* seg = l.current_segment();
     ct_assume(seg);
@@ -321,7 +344,10 @@ void process_listing_code(const Context* ctx, Listing& l,
         const RDSegment* s = l.current_segment();
         ct_assume(s);
         ct_assume(s->perm & SP_X);
-        memprocess::process_function_graph(ctx, functions, address);
+
+        // Functions are collected only once, when the listing is built
+        if(functions)
+            memprocess::process_function_graph(ctx, *functions, address);
     }
     else if(memory::has_flag(seg, address, BF_REFSTO)) {
         l.pop_indent();
@@ -336,6 +362,77 @@ void process_listing_code(const Context* ctx, Listing& l,
     address += len;
 }
 
+void process_listing_item(const Context* ctx, Listing& l,
+                          std::vector<Function>* functions, RDAddress& address,
+                          RDAddress end) {
+    const RDSegment* seg = l.current_segment();
+    ct_assume(seg);
+
+    if(memory::is_unknown(seg, address))
+        memprocess::process_listing_unknown(l, address, end);
+    else if(memory::has_flag(seg, address, BF_DATA))
+        memprocess::process_listing_data(ctx, l, address);
+    else if(memory::has_flag(seg, address, BF_CODE)) {
+        l.push_indent(4);
+        memprocess::process_listing_code(ctx, l, functions, address);
+        l.pop_indent(4);
+    }
+    else
+        ct_unreachable;
+}
+
+void process_listing_block(const Context* ctx, Listing& l,
+                           const Listing::Block& b,
+                           std::vector<Function>* functions,
+                           RDAddress& address) {
+    if(b.start == b.segment->start)
+        l.segment(b.segment);
+    else
+        l.enter_segment(b.segment, b.start);
+
+    for(address = b.start; address < b.end;)
+        memprocess::process_listing_item(ctx, l, functions, address, b.end);
+}
+
+void generate_listing_block(Listing& w, const Listing::Block& b) {
+    RDAddress address;
+    memprocess::process_listing_block(state::context, w, b, nullptr, address);
+    ct_assume(address == b.end);
+}
+
+// Segments only read their own flags and the database: safe to run
+// concurrently, each one in its own shard
+void process_listing_segment(const Context* ctx, Listing& l,
+                             std::vector<Function>* f, const RDSegment* seg) {
+    if(!l.is_virtual()) {
+        l.segment(seg);
+
+        for(RDAddress address = seg->start; address < seg->end;)
+            memprocess::process_listing_item(ctx, l, f, address, seg->end);
+
+        return;
+    }
+
+    Listing rows; // Counted only, windows generate the actual rows
+    rows.set_counting(true);
+
+    for(RDAddress address = seg->start; address < seg->end;) {
+        Listing::Block b{
+            .segment = seg,
+            .start = address,
+            .end =
+                std::min<RDAddress>(address + Listing::BLOCK_SIZE, seg->end),
+            .first = 0,
+            .count = 0,
+        };
+
+        rows.clear();
+        memprocess::process_listing_block(ctx, rows, b, f, address);
+        b.end = address; // Items can cross the nominal block end
+        l.add_block(b, rows);
+    }
+}
+
 void process_refsto(Context* ctx, const RDSegment* seg, RDAddress& address) {
     auto is_range_unkn = [&](RDAddress raddr, usize n) {
         return memory::range_is(seg, raddr, n,
@@ -468,45 +565,46 @@ void process_memory() {
         }
     }
 
-    state::context->program.functions = std::move(f);
+    state::context->program.set_functions(std::move(f));
 }
 
-void process_listing() {
-    const Context* ctx = state::context;
+void process_listing(bool functions) {
+    Context* ctx = state::context;
     ct_assume(ctx);
 
-    Listing l;
-    std::vector<Function> f;
+    // Pre-layout graphs were measured on the listing being replaced
+    ctx->prelayout.cancel();
 
-    const RDSegment* seg;
-    slice_foreach(seg, &ctx->program.segments) {
-        l.segment(seg);
+    bool lazy = state::params.flags & IF_LAZYLISTING;
+    usize n = slice_length(&ctx->program.segments);
+    std::vector<Listing> shards(n);
+    std::vector<std::vector<Function>> shardfuncs(n);
 
-        for(RDAddress address = seg->start; address < seg->end;) {
-            if(memory::is_unknown(seg, address)) {
-                memprocess::process_listing_unknown(l, address);
-                continue;
-            }
+    utils::parallel_for(n, [&](usize i) {
+        if(lazy) shards[i].set_generator(memprocess::generate_listing_block);
+        const RDSegment* seg = &slice_at(&ctx->program.segments, i);
+        memprocess::process_listing_segment(
+            ctx, shards[i], functions ? &shardfuncs[i] : nullptr, seg);
+    });
 
-            if(memory::has_flag(seg, address, BF_DATA)) {
-                memprocess::process_listing_data(ctx, l, address);
-                continue;
-            }
-
-            if(memory::has_flag(seg, address, BF_CODE)) {
-                l.push_indent(4);
-                memprocess::process_listing_code(ctx, l, f, address);
-                l.pop_indent(4);
-                continue;
-            }
+    Listing l;
+    std::vector<Function> f;
+    if(lazy) l.set_generator(memprocess::generate_listing_block);
 
-            ct_unreachable;
-        }
+    for(usize i = 0; i < n; i++) {
+        l.append(shards[i]);
+        std::move(shardfuncs[i].begin(), shardfuncs[i].end(),
+                  std::back_inserter(f));
     }
 
     spdlog::info("Listing completed ({} items)", l.size());
-    state::context->program.functions = std::move(f);
+    if(functions) state::context->program.set_functions(std::move(f));
     state::context->listing = std::move(l);
+    state::context->invalidate_symbols();
+    state::context->invalidate_call_graph();
+    state::context->invalidate_jumps();
+    state::context->rdilcache.invalidate(state::context->program);
+    state::context->bump_revision();
 }
 
 } // namespace redasm::memprocess
@@ -8,7 +8,7 @@ namespace memprocess {
 
 void merge_code(Emulator* e);
 void process_memory();
-void process_listing();
+void process_listing(bool functions = true);
 
 } // namespace memprocess
 
@@ -77,9 +77,16 @@ bool Worker::execute(const RDWorkerStatus** s) {
             case WS_FINALIZE: this->finalize_step(); break;
             default: ct_unreachable;
         }
+
+        // Generated windows don't match the skeleton anymore
+        if(state::context->listing.is_stale()) {
+            memprocess::process_listing(false);
+            m_status->listingchanged = true;
+        }
     }
     else {
-        memprocess::process_listing();
+        // Functions restored from a snapshot aren't rebuilt from flags
+        memprocess::process_listing(!m_keepfunctions);
         m_status->listingchanged = true;
     }
 
@@ -91,9 +98,15 @@ void Worker::execute(usize step) {
     if(step == m_currentstep) return;
 
     m_currentstep = step;
+    m_keepfunctions = false;
     this->execute(nullptr);
 }
 
+void Worker::complete() {
+    m_currentstep = WS_DONE;
+    m_keepfunctions = true;
+}
+
 void Worker::init_step() {
     m_status->filepath = state::context->program.file->source;
     m_status->filesize = state::context->program.file->length;
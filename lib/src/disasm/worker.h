@@ -12,6 +12,7 @@ public:
     Worker();
     bool execute(const RDWorkerStatus** s);
     void execute(usize step);
+    void complete(); // Functions are kept until the next analysis step
 
 private:
     void init_step();
@@ -29,6 +30,7 @@ private:
     std::unordered_map<std::string_view, usize> m_analyzerruns;
     std::unique_ptr<RDWorkerStatus> m_status;
     usize m_currentstep;
+    bool m_keepfunctions{false};
 };
 
 } // namespace redasm
@@ -0,0 +1,83 @@
+#include "generator.h"
+#include <vector>
+
+namespace redasm::graphgen {
+
+namespace {
+
+// if(c0) { if(c1) { ... } } with 'n' levels, every level has its own join
+void generate_nested(Graph& g, usize n) {
+    RDGraphNode cond = g.set_root(g.add_node());
+    std::vector<RDGraphNode> joins;
+
+    for(usize i = 0; i < n; i++) {
+        RDGraphNode join = g.add_node();
+        g.add_edge(cond, join); // else
+
+        if(!joins.empty()) g.add_edge(join, joins.back());
+        joins.push_back(join);
+
+        if(i + 1 < n) {
+            RDGraphNode next = g.add_node();
+            g.add_edge(cond, next); // then
+            cond = next;
+        }
+    }
+}
+
+// 'n' cases plus default, some of them fall through to the next one
+void generate_switch(Graph& g, usize n) {
+    RDGraphNode root = g.set_root(g.add_node());
+    RDGraphNode exit = g.add_node();
+    RDGraphNode prev = 0;
+
+    for(usize i = 0; i < n; i++) {
+        RDGraphNode c = g.add_node();
+        g.add_edge(root, c);
+
+        if(prev && !(i % 4))
+            g.add_edge(prev, c);
+        else if(prev)
+            g.add_edge(prev, exit);
+
+        prev = c;
+    }
+
+    if(prev) g.add_edge(prev, exit);
+    g.add_edge(root, exit); // default
+}
+
+// Chain of 'n' loops that can be entered from two different blocks
+void generate_irreducible(Graph& g, usize n) {
+    RDGraphNode entry = g.set_root(g.add_node());
+
+    for(usize i = 0; i < n; i++) {
+        RDGraphNode a = g.add_node(), b = g.add_node();
+        RDGraphNode next = g.add_node();
+
+        g.add_edge(entry, a);
+        g.add_edge(entry, b);
+        g.add_edge(a, b);
+        g.add_edge(b, a);
+        g.add_edge(a, next);
+        g.add_edge(b, next);
+        entry = next;
+    }
+}
+
+} // namespace
+
+bool generate(Graph& g, usize pattern, usize n) {
+    g.clear();
+
+    switch(pattern) {
+        case GRAPHPATTERN_NESTED: generate_nested(g, n); break;
+        case GRAPHPATTERN_SWITCH: generate_switch(g, n); break;
+        case GRAPHPATTERN_IRREDUCIBLE: generate_irreducible(g, n); break;
+        default: return false;
+    }
+
+    return true;
+}
+
+} // namespace redasm::graphgen
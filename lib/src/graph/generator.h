@@ -0,0 +1,11 @@
+#pragma once
+
+#include "graph.h"
+#include <redasm/graph.h>
+
+namespace redasm::graphgen {
+
+// Synthetic control flow graphs that stress graph layouts
+bool generate(Graph& g, usize pattern, usize n);
+
+} // namespace redasm::graphgen
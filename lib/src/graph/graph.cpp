@@ -1,22 +1,57 @@
 #include "graph.h"
-#include "../utils/hash.h"
 #include <algorithm>
+#include <tuple>
 
 namespace redasm {
 
+namespace {
+
+constexpr u64 NODE_SEED = 0x6e6f6465;
+constexpr u64 EDGE_SEED = 0x65646765;
+constexpr u64 ROOT_SEED = 0x726f6f74;
+
+// splitmix64 finalizer
+u64 mix(u64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+u64 node_hash(RDGraphNode n) { return mix(n ^ NODE_SEED); }
+
+u64 edge_hash(const RDGraphEdge& e) {
+    return mix(mix(e.src ^ EDGE_SEED) ^ e.dst);
+}
+
+} // namespace
+
 void Graph::clear() {
     m_incomings.clear();
     m_outgoings.clear();
+    m_edgeset.clear();
     m_edges.clear();
     m_nodes.clear();
+    m_hash = 0;
     m_nodeid = 0;
     m_root = {0};
 }
 
 void Graph::remove_edge(const RDGraphEdge* edge) {
+    // 'edge' may point to an adjacency list
+    RDGraphEdge e = *edge;
+    if(!m_edgeset.erase(e)) return;
+
+    m_hash ^= edge_hash(e);
+
+    Graph::remove_adjacent(m_outgoings, e.src, e);
+    Graph::remove_adjacent(m_incomings, e.dst, e);
+
     auto it = std::find_if(
-        m_edges.begin(), m_edges.end(), [edge](const RDGraphEdge& e) {
-            return std::tie(edge->src, edge->dst) == std::tie(e.src, e.dst);
+        m_edges.begin(), m_edges.end(), [e](const RDGraphEdge& x) {
+            return std::tie(e.src, e.dst) == std::tie(x.src, x.dst);
         });
 
     if(it != m_edges.end())
@@ -29,17 +64,32 @@ void Graph::remove_node(RDGraphNode n) {
         return;
 
     m_nodes.erase(it);
+    m_hash ^= node_hash(n);
     this->remove_edges(n);
 }
 
 void Graph::add_edge(RDGraphNode src, RDGraphNode dst) {
-    if(!this->contains_edge(src, dst))
-        m_edges.push_back({src, dst});
+    RDGraphEdge e{src, dst};
+    if(!m_edgeset.insert(e).second) return;
+
+    m_hash ^= edge_hash(e);
+
+    usize n = std::max(src, dst) + 1;
+
+    if(m_outgoings.size() < n) {
+        m_outgoings.resize(n);
+        m_incomings.resize(n);
+    }
+
+    m_outgoings[src].push_back(e);
+    m_incomings[dst].push_back(e);
+    m_edges.push_back(e);
 }
 
 RDGraphNode Graph::add_node() {
     RDGraphNode n = ++m_nodeid;
     m_nodes.push_back(n);
+    m_hash ^= node_hash(n);
     return n;
 }
 
@@ -60,42 +110,45 @@ std::string Graph::generate_dot() const {
     return s;
 }
 
-u32 Graph::hash() const { return hash::murmur3(this->generate_dot()); }
+u32 Graph::hash() const {
+    u64 h = this->structural_hash();
+    return static_cast<u32>(h ^ (h >> 32));
+}
+
+u64 Graph::structural_hash() const {
+    return m_hash ^ mix(m_root ^ ROOT_SEED);
+}
 
 const RDGraphEdge* Graph::edge(RDGraphNode src, RDGraphNode dst) const {
-    for(const RDGraphEdge& e : m_edges) {
-        if((e.src == src) && (e.dst == dst))
+    if(!m_edgeset.contains({src, dst})) return nullptr;
+
+    const Edges* out = Graph::adjacent(m_outgoings, src);
+    ct_assume(out);
+
+    for(const RDGraphEdge& e : *out) {
+        if(e.dst == dst)
             return &e;
     }
 
-    return nullptr;
+    ct_unreachable;
 }
 
 usize Graph::outgoing(RDGraphNode n, const RDGraphEdge** edges) const {
-    m_outgoings.clear();
-
-    for(const RDGraphEdge& e : m_edges) {
-        if(e.src == n)
-            m_outgoings.push_back(e);
-    }
+    const Edges* out = Graph::adjacent(m_outgoings, n);
+    if(!out) return 0;
 
     if(edges)
-        *edges = m_outgoings.data();
-    return m_outgoings.size();
+        *edges = out->data();
+    return out->size();
 }
 
 usize Graph::incoming(RDGraphNode n, const RDGraphEdge** edges) const {
-    m_incomings.clear();
-
-    for(const RDGraphEdge& e : m_edges) {
-        if(e.dst == n)
-            m_incomings.push_back(e);
-    }
+    const Edges* in = Graph::adjacent(m_incomings, n);
+    if(!in) return 0;
 
     if(edges)
-        *edges = m_incomings.data();
-
-    return m_incomings.size();
+        *edges = in->data();
+    return in->size();
 }
 
 usize Graph::nodes(const RDGraphNode** nodes) const {
@@ -115,28 +168,38 @@ std::string Graph::node_label(RDGraphNode n) const {
 }
 
 void Graph::remove_outgoing_edges(RDGraphNode n) {
-    this->outgoing(n, nullptr);
+    const Edges* out = Graph::adjacent(m_outgoings, n);
+    if(!out) return;
 
-    for(const RDGraphEdge& e : m_outgoings)
-        this->remove_edge(&e);
+    // remove_edge() shrinks the list
+    while(!out->empty())
+        this->remove_edge(&out->back());
 }
 
 void Graph::remove_incoming_edges(RDGraphNode n) {
-    this->incoming(n, nullptr);
+    const Edges* in = Graph::adjacent(m_incomings, n);
+    if(!in) return;
 
-    for(const RDGraphEdge& e : m_incomings)
-        this->remove_edge(&e);
+    while(!in->empty())
+        this->remove_edge(&in->back());
 }
 
 void Graph::remove_edges(RDGraphNode n) {
-    for(usize i = 0; i < m_edges.size();) {
-        const RDGraphEdge& e = m_edges[i];
+    this->remove_outgoing_edges(n);
+    this->remove_incoming_edges(n);
+}
 
-        if(e.src == n)
-            this->remove_edge(&e);
-        else
-            i++;
-    }
+void Graph::remove_adjacent(std::vector<Edges>& adj, RDGraphNode n,
+                            const RDGraphEdge& edge) {
+    if(n >= adj.size()) return;
+
+    auto it = std::find_if(
+        adj[n].begin(), adj[n].end(), [edge](const RDGraphEdge& e) {
+            return std::tie(edge.src, edge.dst) == std::tie(e.src, e.dst);
+        });
+
+    if(it != adj[n].end())
+        adj[n].erase(it);
 }
 
 } // namespace redasm
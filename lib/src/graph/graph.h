@@ -2,6 +2,7 @@
 
 #include <redasm/graph.h>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace redasm {
@@ -20,6 +21,7 @@ public:
     RDGraphNode add_node();
     std::string generate_dot() const;
     u32 hash() const;
+    u64 structural_hash() const;
 
     RDGraphNode set_root(RDGraphNode n) {
         m_root = n;
@@ -47,10 +49,21 @@ protected:
     void remove_incoming_edges(RDGraphNode n);
     void remove_edges(RDGraphNode n);
 
+private:
+    static const Edges* adjacent(const std::vector<Edges>& adj,
+                                 RDGraphNode n) {
+        return n < adj.size() ? &adj[n] : nullptr;
+    }
+
+    static void remove_adjacent(std::vector<Edges>& adj, RDGraphNode n,
+                                const RDGraphEdge& edge);
+
 protected:
-    mutable Edges m_incomings, m_outgoings;
+    std::vector<Edges> m_outgoings, m_incomings; // Indexed by node
+    std::unordered_set<RDGraphEdge> m_edgeset;
     Edges m_edges;
     Nodes m_nodes;
+    u64 m_hash{0}; // Order independent, updated on every change
     usize m_nodeid{0};
     RDGraphNode m_root{0};
 };
@@ -1,4 +1,6 @@
 #include "layeredlayout.h"
+#include "../../context.h"
+#include "../../state.h"
 #include <queue>
 #include <unordered_set>
 
@@ -13,13 +15,55 @@ constexpr int LLAYOUT_NODE_PADDING = (2 * LLAYOUT_PADDING);
 
 } // namespace
 
-LayeredLayout::LayeredLayout(StyledGraph* graph, int type)
-    : m_graph{graph}, m_layouttype{type} {}
+bool LLLane::overlaps(int lo, int hi) const {
+    // First range starting after 'hi', the previous one may overlap
+    auto it = m_ranges.upper_bound(hi);
+    if(it == m_ranges.begin()) return false;
+    return std::prev(it)->second >= lo;
+}
+
+void LLLane::insert(int lo, int hi) {
+    // Merge with overlapping and adjacent ranges
+    auto it = m_ranges.upper_bound(hi + 1);
+
+    while(it != m_ranges.begin()) {
+        auto prev = std::prev(it);
+        if(prev->second + 1 < lo) break;
+
+        lo = std::min(lo, prev->first);
+        hi = std::max(hi, prev->second);
+        it = m_ranges.erase(prev);
+    }
+
+    m_ranges.emplace(lo, hi);
+}
+
+void LLLane::erase(int pos) {
+    auto it = m_ranges.upper_bound(pos);
+    if(it == m_ranges.begin()) return;
+
+    --it;
+    auto [lo, hi] = *it;
+    if(hi < pos) return;
+
+    m_ranges.erase(it);
+    if(lo < pos) m_ranges.emplace(lo, pos - 1);
+    if(pos < hi) m_ranges.emplace(pos + 1, hi);
+}
+
+LayeredLayout::LayeredLayout(StyledGraph* graph, int type,
+                             LayoutCache::Pool pool)
+    : m_graph{graph}, m_layouttype{type}, m_cachepool{pool} {}
 
 bool LayeredLayout::execute() {
     if(!m_graph->root())
         return false;
 
+    // Sizes are padded below, the key must be taken before
+    Context* ctx = state::context;
+    LayoutCache::Key key = LayoutCache::make_key(*m_graph, m_layouttype);
+    if(ctx && ctx->layoutcache.restore(key, *m_graph)) return true;
+
     m_blocks.clear();
     m_colx.clear();
     m_rowy.clear();
@@ -29,9 +73,9 @@ bool LayeredLayout::execute() {
     m_coledgecount.clear();
     m_rowedgey.clear();
     m_blockorder.clear();
-    m_horizedges.clear();
-    m_vertedges.clear();
-    m_edgevalid.clear();
+    m_horizlanes.clear();
+    m_vertlanes.clear();
+    m_blockedrows.clear();
 
     this->create_blocks(); // Create render nodes
     this->make_acyclic();  // Construct acyclic graph where each node is used as
@@ -47,6 +91,8 @@ bool LayeredLayout::execute() {
     this->compute_row_column_positions(); // Compute row and column positions
     this->compute_node_positions();       // Compute node positions
     this->precompute_edge_coordinates();  // Precompute coordinates for edges
+
+    if(ctx) ctx->layoutcache.store(key, m_graph->get_layout(), m_cachepool);
     return true;
 }
 
@@ -160,25 +206,24 @@ void LayeredLayout::make_acyclic() {
 }
 
 void LayeredLayout::prepare_edge_routing() {
-    m_horizedges.resize(m_blocks[m_graph->root()].rowcount + 1);
-    m_vertedges.resize(m_blocks[m_graph->root()].rowcount + 1);
-    m_edgevalid.resize(m_blocks[m_graph->root()].rowcount + 1);
-
-    for(int row = 0; row < m_blocks[m_graph->root()].rowcount + 1; row++) {
-        m_horizedges[row].resize(m_blocks[m_graph->root()].colcount + 1);
-        m_vertedges[row].resize(m_blocks[m_graph->root()].colcount + 1);
-        LayeredLayout::init_deque(m_edgevalid[row],
-                                  m_blocks[m_graph->root()].colcount + 1, true);
-
-        for(int col = 0; col < m_blocks[m_graph->root()].colcount + 1; col++) {
-            m_horizedges[row][col].clear();
-            m_vertedges[row][col].clear();
-        }
-    }
+    int nrows = m_blocks[m_graph->root()].rowcount + 1;
+    int ncols = m_blocks[m_graph->root()].colcount + 1;
+
+    m_horizlanes.assign(nrows, {});
+    m_vertlanes.assign(ncols, {});
+
+    // Rows blocked by a node, counted per column: checking whether an edge
+    // can run vertically through a column is O(1)
+    m_blockedrows.assign(ncols, std::vector<int>(nrows + 1, 0));
 
     for(const auto& item : m_blocks) {
         const LLBlock& block = item.second;
-        m_edgevalid[block.row][block.col + 1] = false;
+        m_blockedrows[block.col + 1][block.row + 1] = 1;
+    }
+
+    for(std::vector<int>& rows : m_blockedrows) {
+        for(int row = 0; row < nrows; row++)
+            rows[row + 1] += rows[row];
     }
 }
 
@@ -193,8 +238,7 @@ void LayeredLayout::perform_edge_routing() {
         for(usize i = 0; i < c; i++) {
             const RDGraphEdge& e = edges[i];
             LLBlock& end = m_blocks[e.dst];
-            start.edges.push_back(this->route_edge(m_horizedges, m_vertedges,
-                                                   m_edgevalid, start, end));
+            start.edges.push_back(this->route_edge(start, end));
         }
     }
 }
@@ -205,19 +249,12 @@ void LayeredLayout::compute_edge_count() {
     LayeredLayout::init_deque(m_rowedgecount,
                               m_blocks[m_graph->root()].rowcount + 1, 0);
 
-    for(int row = 0; row < m_blocks[m_graph->root()].rowcount + 1; row++) {
-        for(int col = 0; col < m_blocks[m_graph->root()].colcount + 1; col++) {
-            if(static_cast<int>(m_horizedges[row][col].size()) >
-               m_rowedgecount[row])
-                m_rowedgecount[row] =
-                    static_cast<int>(m_horizedges[row][col].size());
-
-            if(static_cast<int>(m_vertedges[row][col].size()) >
-               m_coledgecount[col])
-                m_coledgecount[col] =
-                    static_cast<int>(m_vertedges[row][col].size());
-        }
-    }
+    // Lanes are created on demand, the lane count is the edge count
+    for(usize row = 0; row < m_horizlanes.size(); row++)
+        m_rowedgecount[row] = static_cast<int>(m_horizlanes[row].size());
+
+    for(usize col = 0; col < m_vertlanes.size(); col++)
+        m_coledgecount[col] = static_cast<int>(m_vertlanes[col].size());
 }
 
 void LayeredLayout::compute_row_column_sizes() {
@@ -362,24 +399,15 @@ void LayeredLayout::precompute_edge_coordinates() {
     }
 }
 
-LLEdge LayeredLayout::route_edge(LayeredLayout::EdgesVector& horizedges,
-                                 LayeredLayout::EdgesVector& vertedges,
-                                 Matrix<bool>& edgevalid, LLBlock& start,
-                                 LLBlock& end) {
+LLEdge LayeredLayout::route_edge(LLBlock& start, LLBlock& end) {
     LLEdge edge;
     edge.sourceblock = &start;
     edge.targetblock = &end;
 
     // Find edge index for initial outgoing line
-    int i = 0;
-
-    while(true) {
-        if(!this->is_edge_marked(vertedges, start.row + 1, start.col + 1, i))
-            break;
-        i += 1;
-    }
+    int i = LayeredLayout::find_lane(m_vertlanes[start.col + 1], start.row + 1,
+                                     start.row + 1);
 
-    this->mark_edge(vertedges, start.row + 1, start.col + 1, i);
     edge.add_point(start.row + 1, start.col + 1);
     edge.startindex = i;
     bool horiz = false;
@@ -399,33 +427,26 @@ LLEdge LayeredLayout::route_edge(LayeredLayout::EdgesVector& horizedges,
     int col = start.col + 1;
 
     if(minrow != maxrow) {
-        auto check_column = [minrow, maxrow, &edgevalid](int column) -> bool {
-            if(column < 0 ||
-               column >= static_cast<int>(edgevalid[minrow].size()))
-                return false;
-
-            for(int row = minrow; row < maxrow; row++) {
-                if(!edgevalid[row][column])
-                    return false;
-            }
-
-            return true;
+        auto check_column = [&](int column) {
+            return this->check_column(column, minrow, maxrow);
         };
 
         if(!check_column(col)) {
             if(!check_column(end.col + 1)) {
-                int ofs = 0;
+                // Bounded: give up when every column has been checked
+                int ncols = static_cast<int>(m_vertlanes.size());
+                bool found = false;
 
-                while(true) {
+                for(int ofs = 0; !found && ofs <= ncols; ofs++) {
                     col = start.col + 1 - ofs;
-                    if(check_column(col))
-                        break;
+                    found = check_column(col);
+                    if(found) break;
 
                     col = start.col + 1 + ofs;
-                    if(check_column(col))
-                        break;
-                    ofs += 1;
+                    found = check_column(col);
                 }
+
+                if(!found) col = start.col + 1;
             }
             else
                 col = end.col + 1;
@@ -446,8 +467,8 @@ LLEdge LayeredLayout::route_edge(LayeredLayout::EdgesVector& horizedges,
             maxcol = col;
         }
 
-        int index = this->find_horiz_edge_index(horizedges, start.row + 1,
-                                                mincol, maxcol);
+        int index =
+            this->find_horiz_edge_index(start.row + 1, mincol, maxcol);
         edge.add_point(start.row + 1, col, index);
         horiz = true;
     }
@@ -456,8 +477,8 @@ LLEdge LayeredLayout::route_edge(LayeredLayout::EdgesVector& horizedges,
         // Not in same row, need to generate a line for moving to the correct
         // row
         if(col == (start.col + 1))
-            this->mark_edge(vertedges, start.row + 1, start.col + 1, i, false);
-        int index = this->find_vert_edge_index(vertedges, col, minrow, maxrow);
+            m_vertlanes[start.col + 1][i].erase(start.row + 1);
+        int index = this->find_vert_edge_index(col, minrow, maxrow);
         if(col == (start.col + 1))
             edge.startindex = index;
         edge.add_point(end.row, col, index);
@@ -476,8 +497,7 @@ LLEdge LayeredLayout::route_edge(LayeredLayout::EdgesVector& horizedges,
             mincol = end.col + 1;
             maxcol = col;
         }
-        int index =
-            this->find_horiz_edge_index(horizedges, end.row, mincol, maxcol);
+        int index = this->find_horiz_edge_index(end.row, mincol, maxcol);
         edge.add_point(end.row, end.col + 1, index);
         horiz = true;
     }
@@ -485,80 +505,39 @@ LLEdge LayeredLayout::route_edge(LayeredLayout::EdgesVector& horizedges,
     // If last line was horizontal, choose the ending edge index for the
     // incoming edge
     if(horiz) {
-        int index = this->find_vert_edge_index(vertedges, end.col + 1, end.row,
-                                               end.row);
+        int index =
+            this->find_vert_edge_index(end.col + 1, end.row, end.row);
         edge.points[static_cast<int>(edge.points.size()) - 1].index = index;
     }
 
     return edge;
 }
 
-int LayeredLayout::find_horiz_edge_index(LayeredLayout::EdgesVector& edges,
-                                         int row, int mincol,
-                                         int maxcol) const {
-    // Find a valid index
-    int i = 0;
-
-    while(true) {
-        bool valid = true;
-
-        for(int col = mincol; col < maxcol + 1; col++) {
-            if(!this->is_edge_marked(edges, row, col, i))
-                continue;
-            valid = false;
-            break;
-        }
-
-        if(valid)
-            break;
-        i++;
-    }
+bool LayeredLayout::check_column(int col, int minrow, int maxrow) const {
+    if(col < 0 || col >= static_cast<int>(m_blockedrows.size())) return false;
 
-    // Mark chosen index as used
-    for(int col = mincol; col < maxcol + 1; col++)
-        this->mark_edge(edges, row, col, i);
-    return i;
+    const std::vector<int>& rows = m_blockedrows[col];
+    return rows[maxrow] == rows[minrow];
 }
 
-int LayeredLayout::find_vert_edge_index(LayeredLayout::EdgesVector& edges,
-                                        int col, int minrow, int maxrow) const {
-    // Find a valid index
-    int i = 0;
-
-    while(true) {
-        bool valid = true;
-
-        for(int row = minrow; row < maxrow + 1; row++) {
-            if(!this->is_edge_marked(edges, row, col, i))
-                continue;
-            valid = false;
-            break;
-        }
-
-        if(valid)
-            break;
-        i++;
-    }
-
-    // Mark chosen index as used
-    for(int row = minrow; row < maxrow + 1; row++)
-        this->mark_edge(edges, row, col, i);
-    return i;
+int LayeredLayout::find_horiz_edge_index(int row, int mincol, int maxcol) {
+    return LayeredLayout::find_lane(m_horizlanes[row], mincol, maxcol);
 }
 
-bool LayeredLayout::is_edge_marked(LayeredLayout::EdgesVector& edges, int row,
-                                   int col, int index) const {
-    if(index >= static_cast<int>(edges[row][col].size()))
-        return false;
-    return edges[row][col][index];
+int LayeredLayout::find_vert_edge_index(int col, int minrow, int maxrow) {
+    return LayeredLayout::find_lane(m_vertlanes[col], minrow, maxrow);
 }
 
-void LayeredLayout::mark_edge(LayeredLayout::EdgesVector& edges, int row,
-                              int col, int index, bool used) const {
-    while(static_cast<int>(edges[row][col].size()) <= index)
-        edges[row][col].push_back(false);
+int LayeredLayout::find_lane(LLLanes& lanes, int lo, int hi) {
+    // Find the first lane where [lo, hi] is free and mark it as used
+    usize i = 0;
+
+    while(i < lanes.size() && lanes[i].overlaps(lo, hi))
+        i++;
 
-    edges[row][col][index] = used;
+    if(i == lanes.size()) lanes.emplace_back();
+    lanes[i].insert(lo, hi);
+    return static_cast<int>(i);
 }
 
 void LayeredLayout::adjust_graph_layout(LLBlock& block, int col, int row) {
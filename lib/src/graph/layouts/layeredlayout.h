@@ -1,10 +1,13 @@
 #pragma once
 
 #include "../styledgraph.h"
+#include "layoutcache.h"
 #include <algorithm>
 #include <deque>
+#include <map>
 #include <redasm/redasm.h>
 #include <unordered_map>
+#include <vector>
 
 namespace redasm {
 
@@ -45,14 +48,24 @@ struct LLBlock {
     int row{0}, rowcount{0};
 };
 
-class LayeredLayout {
+// Occupied cells of an edge lane, stored as disjoint [start, end] ranges
+class LLLane {
+public:
+    [[nodiscard]] bool overlaps(int lo, int hi) const;
+    void insert(int lo, int hi);
+    void erase(int pos);
+
 private:
-    template<typename T>
-    using Matrix = std::deque<std::deque<T>>;
-    using EdgesVector = Matrix<std::deque<bool>>;
+    std::map<int, int> m_ranges;
+};
+
+// Lanes of a row (horizontal edges) or of a column (vertical edges)
+using LLLanes = std::vector<LLLane>;
 
+class LayeredLayout {
 public:
-    LayeredLayout(StyledGraph* graph, int type);
+    LayeredLayout(StyledGraph* graph, int type,
+                  LayoutCache::Pool pool = LayoutCache::POOL_UI);
     bool execute();
 
 private: // Refactored functions
@@ -67,15 +80,11 @@ private: // Refactored functions
     void precompute_edge_coordinates();
 
 private: // Algorithm functions
-    LLEdge route_edge(EdgesVector& horizedges, EdgesVector& vertedges,
-                      Matrix<bool>& edgevalid, LLBlock& start, LLBlock& end);
-    int find_horiz_edge_index(EdgesVector& edges, int row, int mincol,
-                              int maxcol) const;
-    int find_vert_edge_index(EdgesVector& edges, int col, int minrow,
-                             int maxrow) const;
-    bool is_edge_marked(EdgesVector& edges, int row, int col, int index) const;
-    void mark_edge(EdgesVector& edges, int row, int col, int index,
-                   bool used = true) const;
+    LLEdge route_edge(LLBlock& start, LLBlock& end);
+    bool check_column(int col, int minrow, int maxrow) const;
+    int find_horiz_edge_index(int row, int mincol, int maxcol);
+    int find_vert_edge_index(int col, int minrow, int maxrow);
+    static int find_lane(LLLanes& lanes, int lo, int hi);
     void adjust_graph_layout(LLBlock& block, int col, int row);
     void compute_layout(LLBlock& block);
 
@@ -95,14 +104,16 @@ private:
 private:
     StyledGraph* m_graph;
     int m_layouttype;
+    LayoutCache::Pool m_cachepool;
 
 private: // Layout fields
     std::unordered_map<RDGraphNode, LLBlock> m_blocks;
     std::deque<int> m_colx, m_rowy, m_coledgex, m_rowedgey, m_colwidth,
         m_rowheight, m_coledgecount, m_rowedgecount;
     std::deque<RDGraphNode> m_blockorder;
-    EdgesVector m_horizedges, m_vertedges;
-    Matrix<bool> m_edgevalid;
+    std::vector<LLLanes> m_horizlanes; // Indexed by row
+    std::vector<LLLanes> m_vertlanes;  // Indexed by column
+    std::vector<std::vector<int>> m_blockedrows; // Per column, prefix sums
 };
 
 } // namespace redasm
@@ -0,0 +1,90 @@
+#include "layoutcache.h"
+
+namespace redasm {
+
+namespace {
+
+u64 hash_combine(u64 h, u64 v) {
+    return h ^ (v + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2));
+}
+
+} // namespace
+
+usize LayoutCache::KeyHash::operator()(const Key& k) const {
+    u64 h = hash_combine(k.address, k.graphhash);
+    h = hash_combine(h, k.metricshash);
+    return hash_combine(h, k.type);
+}
+
+LayoutCache::Key LayoutCache::make_key(const StyledGraph& g, usize type) {
+    u64 metrics = 0;
+
+    for(RDGraphNode n : g.nodes()) {
+        metrics = hash_combine(metrics, n);
+        metrics = hash_combine(metrics, static_cast<u32>(g.width(n)));
+        metrics = hash_combine(metrics, static_cast<u32>(g.height(n)));
+    }
+
+    return {
+        .address = g.address(),
+        .graphhash = g.structural_hash(),
+        .metricshash = metrics,
+        .type = type,
+    };
+}
+
+bool LayoutCache::restore(const Key& k, StyledGraph& g) {
+    std::scoped_lock lock{m_mutex};
+
+    auto it = m_layouts.find(k);
+    if(it == m_layouts.end()) return false;
+
+    g.set_layout(it->second.layout);
+
+    // Restored layouts are in use: they move to the front of the UI pool
+    Entry& e = it->second;
+    m_lru[e.pool].erase(e.lru);
+    m_lru[POOL_UI].push_front(k);
+    e.pool = POOL_UI;
+    e.lru = m_lru[POOL_UI].begin();
+    this->evict(POOL_UI);
+    return true;
+}
+
+void LayoutCache::store(const Key& k, StyledGraph::Layout l, Pool pool) {
+    std::scoped_lock lock{m_mutex};
+
+    if(auto it = m_layouts.find(k); it != m_layouts.end()) {
+        m_lru[it->second.pool].erase(it->second.lru);
+        m_layouts.erase(it);
+    }
+
+    m_lru[pool].push_front(k);
+
+    m_layouts.emplace(k, Entry{
+                             .layout = std::move(l),
+                             .pool = pool,
+                             .lru = m_lru[pool].begin(),
+                         });
+
+    this->evict(pool);
+}
+
+void LayoutCache::clear() {
+    std::scoped_lock lock{m_mutex};
+    m_layouts.clear();
+
+    for(LRUList& l : m_lru)
+        l.clear();
+}
+
+void LayoutCache::evict(Pool pool) {
+    LRUList& l = m_lru[pool];
+
+    while(l.size() > POOL_SIZE[pool]) {
+        m_layouts.erase(l.back());
+        l.pop_back();
+    }
+}
+
+} // namespace redasm
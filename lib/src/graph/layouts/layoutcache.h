@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../styledgraph.h"
+#include <array>
+#include <list>
+#include <mutex>
+#include <redasm/types.h>
+#include <unordered_map>
+
+namespace redasm {
+
+// Computed layouts keyed by graph structure and node sizes (that is, font
+// metrics): reopening a graph restores its geometry without a new layout
+class LayoutCache {
+public:
+    struct Key {
+        RDAddress address;
+        u64 graphhash, metricshash;
+        usize type;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    // Each pool has its own budget, background layouts never evict the
+    // ones requested by the UI
+    enum Pool {
+        POOL_UI = 0,
+        POOL_PRELAYOUT,
+        POOL_COUNT,
+    };
+
+    static constexpr std::array<usize, POOL_COUNT> POOL_SIZE = {256, 64};
+
+public:
+    static Key make_key(const StyledGraph& g, usize type);
+    bool restore(const Key& k, StyledGraph& g);
+    void store(const Key& k, StyledGraph::Layout l, Pool pool = POOL_UI);
+    void clear();
+
+private:
+    struct KeyHash {
+        usize operator()(const Key& k) const;
+    };
+
+    using LRUList = std::list<Key>; // Most recently used first
+
+    struct Entry {
+        StyledGraph::Layout layout;
+        Pool pool;
+        LRUList::iterator lru;
+    };
+
+    void evict(Pool pool);
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<Key, Entry, KeyHash> m_layouts;
+    std::array<LRUList, POOL_COUNT> m_lru;
+};
+
+} // namespace redasm
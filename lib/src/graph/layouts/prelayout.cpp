@@ -0,0 +1,180 @@
+#include "prelayout.h"
+#include "../../context.h"
+#include "../../state.h"
+#include "../../surface/surface.h"
+#include "../../utils/parallel.h"
+#include "layeredlayout.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace redasm {
+
+bool PreLayout::start(Context* ctx, const RDPreLayoutParams& params) {
+    ct_assume(ctx);
+    if(m_busy) return false;
+    this->cancel();
+
+    struct Candidate {
+        const Function* function;
+        usize score;
+    };
+
+    std::vector<Candidate> candidates;
+
+    // Big and popular functions first: they are the most likely to be
+    // opened and the slowest to lay out
+    for(const Function& f : ctx->program.functions) {
+        if(f.blocks.size() < std::max<usize>(params.minblocks, 1)) continue;
+
+        usize xrefs = ctx->get_refs_to(f.address).size();
+        candidates.push_back({&f, f.blocks.size() * (xrefs + 1)});
+    }
+
+    std::ranges::stable_sort(candidates,
+                             [](const Candidate& a, const Candidate& b) {
+                                 return a.score > b.score;
+                             });
+
+    // Never lay out more graphs than the pre-layout pool can keep
+    usize n = std::min(candidates.size(),
+                       LayoutCache::POOL_SIZE[LayoutCache::POOL_PRELAYOUT]);
+    if(!n) return true;
+
+    m_candidates.clear();
+    m_candidates.reserve(n);
+
+    for(usize i = 0; i < n; i++)
+        m_candidates.push_back(candidates[i].function);
+
+    m_next = 0;
+    m_functions.clear();
+    m_functions.reserve(n);
+    m_measured = 0;
+    m_measuring = true;
+    m_params = params;
+    m_done = 0;
+    m_total = n;
+    m_busy = true;
+    m_thread = std::thread{&PreLayout::run, this, ctx};
+    return true;
+}
+
+bool PreLayout::step(const Context* ctx) {
+    ct_assume(ctx);
+    if(!m_busy || m_next >= m_candidates.size()) return false;
+
+    // Rendering isn't thread safe (processor, database, lazy listing):
+    // node sizes are computed here, at least one graph per step
+    auto start = std::chrono::steady_clock::now();
+
+    do {
+        Function& f = m_functions.emplace_back(*m_candidates[m_next++]);
+
+        if(!this->measure(ctx, f)) {
+            m_functions.pop_back();
+            m_total--;
+        }
+    } while(m_next < m_candidates.size() &&
+            std::chrono::steady_clock::now() - start < MEASURE_BUDGET);
+
+    bool pending = m_next < m_candidates.size();
+
+    {
+        std::scoped_lock lock{m_mutex};
+        m_measured = m_functions.size();
+        m_measuring = pending;
+    }
+
+    m_cv.notify_one();
+    return pending;
+}
+
+void PreLayout::cancel() {
+    {
+        std::scoped_lock lock{m_mutex};
+        m_cancel = true;
+    }
+
+    m_cv.notify_all();
+    if(m_thread.joinable()) m_thread.join();
+
+    // Candidates point to the program's functions
+    m_candidates.clear();
+    m_next = 0;
+    m_cancel = false;
+    m_busy = false;
+}
+
+RDPreLayoutStatus PreLayout::status() const {
+    return {
+        .done = m_done.load(),
+        .total = m_total.load(),
+        .busy = m_busy.load(),
+    };
+}
+
+void PreLayout::run(Context* ctx) {
+    for(usize first = 0;;) {
+        usize last;
+
+        {
+            std::unique_lock lock{m_mutex};
+            m_cv.wait(lock, [&]() {
+                return m_cancel || m_measured > first || !m_measuring;
+            });
+
+            if(m_cancel || m_measured == first) break;
+            last = m_measured;
+        }
+
+        // Graphs before 'm_measured' are never touched by step()
+        utils::parallel_for(last - first, [&](usize i) {
+            if(m_cancel || state::context != ctx) return;
+
+            LayeredLayout ll{&m_functions[first + i].graph,
+                             static_cast<int>(m_params.type),
+                             LayoutCache::POOL_PRELAYOUT};
+
+            ll.execute(); // Result is stored in the layout cache
+            m_done++;
+        });
+
+        first = last;
+    }
+
+    spdlog::info("Pre-layout completed ({}/{} functions)", m_done.load(),
+                 m_total.load());
+
+    m_busy = false;
+}
+
+bool PreLayout::measure(const Context* ctx, Function& f) const {
+    const Listing& lst = ctx->listing;
+    StyledGraph& g = f.graph;
+    g.clear_layout();
+
+    // Same node sizes as the UI, otherwise the cache key won't match
+    Surface sf{SURFACE_GRAPH};
+
+    for(const Function::BasicBlock& bb : f.blocks) {
+        LIndex startidx = lst.lower_bound(bb.start);
+        if(startidx >= lst.size()) return false;
+
+        LIndex endidx = lst.upper_bound(bb.end, startidx);
+        sf.render_rows(startidx, endidx - startidx);
+
+        usize ncols = 0;
+
+        for(const SurfaceRow& row : sf.rows)
+            ncols = std::max(ncols, row.cells.size());
+
+        float w = static_cast<float>(ncols) * m_params.cellwidth;
+        float h = static_cast<float>(sf.rows.size()) * m_params.cellheight;
+        g.set_width(bb.node, static_cast<int>(w));
+        g.set_height(bb.node, static_cast<int>(h));
+    }
+
+    return true;
+}
+
+} // namespace redasm
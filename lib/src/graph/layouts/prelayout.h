@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../../disasm/function.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <redasm/graph.h>
+#include <thread>
+#include <vector>
+
+namespace redasm {
+
+class Context;
+
+// Post-analysis stage: lays out big function graphs on a thread pool and
+// stores them in the layout cache. Graphs are copied and their nodes are
+// measured by the calling thread a few at a time (see step()), workers lay
+// out every batch as soon as it has been measured.
+class PreLayout {
+public:
+    static constexpr std::chrono::milliseconds MEASURE_BUDGET{4};
+
+    ~PreLayout() { this->cancel(); }
+    bool start(Context* ctx, const RDPreLayoutParams& params);
+    bool step(const Context* ctx);
+    void cancel();
+    RDPreLayoutStatus status() const;
+
+private:
+    void run(Context* ctx);
+    bool measure(const Context* ctx, Function& f) const;
+
+private:
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    RDPreLayoutParams m_params{};
+    std::vector<const Function*> m_candidates; // Best first
+    usize m_next{0};                             // Next candidate to measure
+    std::vector<Function> m_functions; // Reserved upfront, never reallocated
+    usize m_measured{0};               // Guarded by 'm_mutex'
+    bool m_measuring{false};           // Guarded by 'm_mutex'
+    std::atomic<usize> m_done{0}, m_total{0};
+    std::atomic<bool> m_busy{false}, m_cancel{false};
+};
+
+} // namespace redasm
@@ -14,6 +14,34 @@ void StyledGraph::clear() {
     this->clear_layout();
 }
 
+StyledGraph::Layout StyledGraph::get_layout() const {
+    Layout l{
+        .nodes = m_nodeattributes,
+        .areawidth = m_areawidth,
+        .areaheight = m_areaheight,
+    };
+
+    for(const auto& [e, attrs] : m_edgeattributes) {
+        EdgeAttributes& ea = l.edges[e];
+        ea.routes = attrs.routes;
+        ea.arrow = attrs.arrow;
+    }
+
+    return l;
+}
+
+void StyledGraph::set_layout(const Layout& l) {
+    m_nodeattributes = l.nodes;
+    m_areawidth = l.areawidth;
+    m_areaheight = l.areaheight;
+
+    for(const auto& [e, attrs] : l.edges) {
+        EdgeAttributes& ea = m_edgeattributes[e];
+        ea.routes = attrs.routes;
+        ea.arrow = attrs.arrow;
+    }
+}
+
 void StyledGraph::set_color(const RDGraphEdge* e, const std::string& s) {
     m_edgeattributes[*e].color = s;
 }
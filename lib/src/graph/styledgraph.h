@@ -20,9 +20,21 @@ private:
         GraphPoints routes, arrow;
     };
 
+public:
+    // Computed geometry, without edge colors and labels
+    struct Layout {
+        std::unordered_map<RDGraphNode, NodeAttributes> nodes;
+        std::unordered_map<RDGraphEdge, EdgeAttributes> edges;
+        int areawidth{0}, areaheight{0};
+    };
+
 public:
     void clear_layout();
     void clear() override;
+    [[nodiscard]] Layout get_layout() const;
+    void set_layout(const Layout& l);
+    void set_address(RDAddress address) { m_address = address; }
+    [[nodiscard]] RDAddress address() const { return m_address; }
 
 public: // Write
     void set_color(const RDGraphEdge* e, const std::string& s);
@@ -52,6 +64,7 @@ private:
     std::unordered_map<RDGraphNode, NodeAttributes> m_nodeattributes;
     std::unordered_map<RDGraphEdge, EdgeAttributes> m_edgeattributes;
     int m_areawidth{0}, m_areaheight{0};
+    RDAddress m_address{0}; // Owner function, if any
 };
 
 } // namespace redasm
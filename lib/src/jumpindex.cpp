@@ -0,0 +1,71 @@
+#include "jumpindex.h"
+#include "context.h"
+#include "memory/memory.h"
+#include "state.h"
+#include <algorithm>
+
+namespace redasm {
+
+const JumpIndex::Jumps& JumpIndex::query(RDAddress start, RDAddress end) {
+    if(!m_built || m_generation != state::context->jump_generation())
+        this->build();
+
+    m_results.clear();
+    this->query_tree(0, m_jumps.size(), start, end);
+    return m_results;
+}
+
+void JumpIndex::build() {
+    const Context* ctx = state::context;
+    ct_assume(ctx);
+
+    m_generation = ctx->jump_generation();
+    m_jumps.clear();
+
+    for(const Database::RangeRef& r : ctx->get_refs_by_type(CR_JUMP)) {
+        const RDSegment* fromseg = ctx->program.find_segment(r.fromaddr);
+        const RDSegment* toseg = ctx->program.find_segment(r.toaddr);
+        if(!fromseg || !toseg) continue;
+        if(!(fromseg->perm & SP_X) || !(toseg->perm & SP_X)) continue;
+        if(!memory::has_flag(toseg, r.toaddr, BF_CODE)) continue;
+
+        m_jumps.push_back({
+            .fromaddr = r.fromaddr,
+            .toaddr = r.toaddr,
+            .conditional = memory::has_flag(fromseg, r.fromaddr, BF_FLOW),
+        });
+    }
+
+    std::ranges::sort(m_jumps, [](const Jump& a, const Jump& b) {
+        return a.start() < b.start();
+    });
+
+    m_maxend.resize(m_jumps.size());
+    this->build_tree(0, m_jumps.size());
+    m_built = true;
+}
+
+RDAddress JumpIndex::build_tree(usize lo, usize hi) {
+    if(lo >= hi) return 0;
+
+    usize mid = lo + ((hi - lo) / 2);
+    m_maxend[mid] = std::max({m_jumps[mid].end(), this->build_tree(lo, mid),
+                              this->build_tree(mid + 1, hi)});
+    return m_maxend[mid];
+}
+
+void JumpIndex::query_tree(usize lo, usize hi, RDAddress start,
+                           RDAddress end) {
+    if(lo >= hi) return;
+
+    usize mid = lo + ((hi - lo) / 2);
+    if(m_maxend[mid] < start) return; // Whole subtree ends before 'start'
+
+    this->query_tree(lo, mid, start, end);
+    if(m_jumps[mid].start() > end) return; // Right side starts later
+
+    if(m_jumps[mid].end() >= start) m_results.push_back(&m_jumps[mid]);
+    this->query_tree(mid + 1, hi, start, end);
+}
+
+} // namespace redasm
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <redasm/types.h>
+#include <vector>
+
+namespace redasm {
+
+// Static interval tree of jump references, rebuilt lazily when the
+// context's jump generation changes
+class JumpIndex {
+public:
+    struct Jump {
+        RDAddress fromaddr;
+        RDAddress toaddr;
+        bool conditional;
+
+        RDAddress start() const {
+            return fromaddr < toaddr ? fromaddr : toaddr;
+        }
+
+        RDAddress end() const { return fromaddr < toaddr ? toaddr : fromaddr; }
+    };
+
+    using Jumps = std::vector<const Jump*>;
+
+public:
+    // Jumps overlapping [start, end]
+    const Jumps& query(RDAddress start, RDAddress end);
+
+private:
+    void build();
+    RDAddress build_tree(usize lo, usize hi);
+    void query_tree(usize lo, usize hi, RDAddress start, RDAddress end);
+
+private:
+    std::vector<Jump> m_jumps; // Sorted by start()
+    std::vector<RDAddress> m_maxend;
+    Jumps m_results;
+    usize m_generation{0};
+    bool m_built{false};
+};
+
+} // namespace redasm
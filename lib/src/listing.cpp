@@ -1,32 +1,344 @@
 #include "listing.h"
 #include "memory/memory.h"
 #include <algorithm>
+#include <spdlog/spdlog.h>
 #include <utility>
 
 namespace redasm {
 
-Listing::ConstIterator Listing::lower_bound(RDAddress address,
-                                            ConstIterator begin) const {
-    auto it = std::lower_bound(
-        std::move(begin), m_items.end(), address,
-        [](const ListingItem& x, RDAddress addr) { return x.address < addr; });
+usize Listing::size() const {
+    if(m_counting) return m_count;
+    if(!this->is_virtual()) return m_addresses.size();
+    if(m_blocks.empty()) return 0;
+    return m_blocks.back().first + m_blocks.back().count;
+}
+
+RDAddress Listing::address_at(LIndex idx) const {
+    if(this->is_virtual()) return this->window_at(idx).address_at(idx);
+    return m_addresses.at(idx);
+}
+
+RDListingItemType Listing::type_at(LIndex idx) const {
+    if(this->is_virtual()) return this->window_at(idx).type_at(idx);
+    return static_cast<RDListingItemType>(m_types.at(idx));
+}
+
+usize Listing::indent_at(LIndex idx) const {
+    if(this->is_virtual()) return this->window_at(idx).indent_at(idx);
+    return m_indents.at(idx);
+}
+
+ListingItem Listing::at(LIndex idx) const {
+    if(this->is_virtual()) return this->window_at(idx).at(idx);
+    ct_assume(idx < m_addresses.size());
+
+    ListingItem li{};
+    li.type = static_cast<RDListingItemType>(m_types[idx]);
+    li.address = m_addresses[idx];
+    li.indent = m_indents[idx];
+
+    // Sparse columns are only filled for these row types
+    switch(li.type) {
+        case LISTINGITEM_HEX_DUMP:
+        case LISTINGITEM_FILL:
+            if(const RDAddress* v = m_extents.get(idx); v) li.end_address = *v;
+            return li;
+
+        case LISTINGITEM_TYPE: break;
+        default: return li;
+    }
+
+    if(const RDAddress* v = m_extents.get(idx); v) li.end_address = *v;
+    if(const RDType* v = m_dtypes.get(idx); v) li.dtype = *v;
+    if(const usize* v = m_arrayindexes.get(idx); v) li.array_index = *v;
+    if(const usize* v = m_fieldindexes.get(idx); v) li.field_index = *v;
+
+    if(const RDType* v = m_dtypecontexts.get(idx); v)
+        li.dtype_context = *v;
+    else
+        li.dtype_context = li.dtype;
+
+    if(const StringInfo* v = m_strings.get(idx); v) {
+        li.string_index = v->index;
+        li.string_terminator = v->terminator;
+    }
+
+    return li;
+}
+
+const Listing::SymbolRow* Listing::symbol_row(LIndex idx) const {
+    return m_symbolrows.get(idx);
+}
+
+LIndex Listing::lower_bound(RDAddress address, LIndex start) const {
+    if(this->is_virtual()) {
+        usize bidx = this->find_block(address);
+        if(bidx >= m_blocks.size()) return this->size();
+
+        const Block& b = m_blocks[bidx];
+        LIndex lidx = this->window(bidx).lower_bound(address);
+        if(lidx >= b.count) return this->size();
+        lidx += b.first;
+
+        // Duplicate addresses before 'start', scan forward
+        for(; lidx < start && lidx < b.first + b.count; lidx++) {
+            if(this->address_at(lidx) != address) return this->size();
+        }
+
+        return lidx < b.first + b.count ? lidx : this->size();
+    }
+
+    ct_assume(start <= m_addresses.size());
+
+    if(!start) {
+        auto lidx = this->find_row(address);
+        if(lidx && m_addresses[*lidx] == address) return *lidx;
+        return m_addresses.size();
+    }
+
+    auto it = std::lower_bound(m_addresses.begin() + start, m_addresses.end(),
+                               address);
 
-    if(it != m_items.end() && it->address == address) return it;
-    return m_items.end();
+    if(it != m_addresses.end() && *it == address)
+        return std::distance(m_addresses.begin(), it);
+
+    return m_addresses.size();
 };
 
-Listing::ConstIterator Listing::upper_bound(RDAddress address,
-                                            ConstIterator begin) const {
-    return std::upper_bound(
-        std::move(begin), m_items.end(), address,
-        [](RDAddress addr, const ListingItem& x) { return addr < x.address; });
+LIndex Listing::upper_bound(RDAddress address, LIndex start) const {
+    if(this->is_virtual()) {
+        usize bidx = this->find_block(address);
+        LIndex lidx;
+
+        if(bidx < m_blocks.size()) {
+            const Block& b = m_blocks[bidx];
+            lidx = b.first +
+                   std::min(this->window(bidx).upper_bound(address), b.count);
+        }
+        else {
+            auto it = std::upper_bound(
+                m_blocks.begin(), m_blocks.end(), address,
+                [](RDAddress addr, const Block& x) { return addr < x.start; });
+
+            lidx = it != m_blocks.end() ? it->first : this->size();
+        }
+
+        return std::max(lidx, start);
+    }
+
+    ct_assume(start <= m_addresses.size());
+    auto it = std::upper_bound(m_addresses.begin() + start, m_addresses.end(),
+                               address);
+    return std::distance(m_addresses.begin(), it);
+}
+
+tl::optional<LIndex> Listing::find_row(RDAddress address) const {
+    if(this->is_virtual()) {
+        usize bidx = this->find_block(address);
+        if(bidx >= m_blocks.size()) return tl::nullopt;
+
+        const Block& b = m_blocks[bidx];
+        auto lidx = this->window(bidx).find_row(address);
+        if(!lidx || !b.count) return tl::nullopt;
+        return b.first + std::min(*lidx, b.count - 1);
+    }
+
+    auto it = std::upper_bound(
+        m_pagetables.begin(), m_pagetables.end(), address,
+        [](RDAddress addr, const PageTable& x) { return addr < x.start; });
+
+    if(it == m_pagetables.begin()) return tl::nullopt;
+    --it;
+    if(address >= it->end || it->pages.empty()) return tl::nullopt;
+
+    usize tidx = std::distance(m_pagetables.begin(), it);
+    usize pidx = std::min<usize>((address >> PAGE_BITS) -
+                                     (it->start >> PAGE_BITS),
+                                 it->pages.size() - 1);
+
+    // Rows of a single page: bounded search
+    auto b = m_addresses.begin();
+    auto rowit = std::upper_bound(b + it->pages[pidx],
+                                  b + this->page_end(tidx, pidx), address);
+
+    LIndex lidx = std::distance(b, rowit);
+    ct_assume(lidx > it->firstrow);
+    lidx--;
+
+    // Rewind to the first row of this item (segment, function, label...)
+    while(lidx > it->firstrow && m_addresses[lidx - 1] == m_addresses[lidx])
+        lidx--;
+
+    return lidx;
+}
+
+LIndex Listing::page_end(usize tidx, usize pidx) const {
+    const PageTable& t = m_pagetables[tidx];
+    if(pidx + 1 < t.pages.size()) return t.pages[pidx + 1];
+    if(tidx + 1 < m_pagetables.size()) return m_pagetables[tidx + 1].firstrow;
+    return m_addresses.size();
+}
+
+usize Listing::find_block(RDAddress address) const {
+    auto it = std::upper_bound(
+        m_blocks.begin(), m_blocks.end(), address,
+        [](RDAddress addr, const Block& x) { return addr < x.start; });
+
+    if(it == m_blocks.begin()) return m_blocks.size();
+    --it;
+    if(address >= it->end) return m_blocks.size();
+    return std::distance(m_blocks.begin(), it);
+}
+
+const Listing& Listing::window(usize bidx) const {
+    ct_assume(bidx < m_blocks.size());
+    m_tick++;
+
+    if(m_lastwindow < m_windows.size() &&
+       m_windows[m_lastwindow].block == bidx) {
+        m_windows[m_lastwindow].lastused = m_tick;
+        return *m_windows[m_lastwindow].rows;
+    }
+
+    for(usize i = 0; i < m_windows.size(); i++) {
+        if(m_windows[i].block != bidx) continue;
+        m_windows[i].lastused = m_tick;
+        m_lastwindow = i;
+        return *m_windows[i].rows;
+    }
+
+    const Block& b = m_blocks[bidx];
+    auto rows = std::make_unique<Listing>();
+    m_generator(*rows, b);
+
+    // Flags or database changed after the skeleton was built, indices are
+    // left untouched: readers may be iterating them
+    if(rows->size() != b.count) {
+        spdlog::debug("Listing: block @ {:x} changed ({} -> {} rows)",
+                      b.start, b.count, rows->size());
+
+        m_stale = true;
+        if(rows->empty()) rows->hex_dump(b.start, b.end);
+    }
+
+    if(m_windows.size() < WINDOW_CACHE) {
+        m_lastwindow = m_windows.size();
+        m_windows.push_back({bidx, m_tick, std::move(rows)});
+    }
+    else { // Evict the least recently used window
+        auto it = std::min_element(m_windows.begin(), m_windows.end(),
+                                   [](const Window& a, const Window& b) {
+                                       return a.lastused < b.lastused;
+                                   });
+
+        *it = {bidx, m_tick, std::move(rows)};
+        m_lastwindow = std::distance(m_windows.begin(), it);
+    }
+
+    return *m_windows[m_lastwindow].rows;
+}
+
+const Listing& Listing::window_at(LIndex& idx) const {
+    ct_assume(idx < this->size());
+
+    auto it = std::upper_bound(
+        m_blocks.begin(), m_blocks.end(), idx,
+        [](LIndex i, const Block& x) { return i < x.first; });
+
+    ct_assume(it != m_blocks.begin());
+    --it;
+    idx -= it->first;
+
+    const Listing& w = this->window(std::distance(m_blocks.begin(), it));
+    if(idx >= w.size()) idx = w.size() - 1; // Stale window
+    return w;
+}
+
+void Listing::add_block(const Block& b, const Listing& rows) {
+    ct_assume(this->is_virtual());
+    ct_assume(!rows.is_virtual());
+
+    Block nb = b;
+    nb.first = this->size();
+    nb.count = rows.size();
+    m_blocks.push_back(nb);
+
+    m_symbolrows.append(rows.m_symbolrows, nb.first);
+
+    for(LIndex lidx : rows.symbols())
+        m_symbols.push_back(nb.first + lidx);
+    for(LIndex lidx : rows.imports())
+        m_imports.push_back(nb.first + lidx);
+    for(LIndex lidx : rows.exports())
+        m_exports.push_back(nb.first + lidx);
+}
+
+void Listing::append(const Listing& shard) {
+    ct_assume(this->is_virtual() == shard.is_virtual());
+    LIndex offset = this->size();
+
+    if(this->is_virtual()) {
+        for(Block b : shard.m_blocks) {
+            b.first += offset;
+            m_blocks.push_back(b);
+        }
+    }
+    else {
+        m_types.insert(m_types.end(), shard.m_types.begin(),
+                       shard.m_types.end());
+        m_addresses.insert(m_addresses.end(), shard.m_addresses.begin(),
+                           shard.m_addresses.end());
+        m_indents.insert(m_indents.end(), shard.m_indents.begin(),
+                         shard.m_indents.end());
+
+        m_extents.append(shard.m_extents, offset);
+        m_dtypes.append(shard.m_dtypes, offset);
+        m_dtypecontexts.append(shard.m_dtypecontexts, offset);
+        m_arrayindexes.append(shard.m_arrayindexes, offset);
+        m_fieldindexes.append(shard.m_fieldindexes, offset);
+        m_strings.append(shard.m_strings, offset);
+
+        for(PageTable t : shard.m_pagetables) {
+            t.firstrow += offset;
+            for(LIndex& p : t.pages)
+                p += offset;
+            m_pagetables.push_back(std::move(t));
+        }
+    }
+
+    m_symbolrows.append(shard.m_symbolrows, offset);
+
+    for(LIndex lidx : shard.symbols())
+        m_symbols.push_back(offset + lidx);
+    for(LIndex lidx : shard.imports())
+        m_imports.push_back(offset + lidx);
+    for(LIndex lidx : shard.exports())
+        m_exports.push_back(offset + lidx);
+
+    m_currentsegment = shard.m_currentsegment;
 }
 
 void Listing::clear() {
     m_symbols.clear();
     m_imports.clear();
     m_exports.clear();
-    m_items.clear();
+    m_types.clear();
+    m_addresses.clear();
+    m_indents.clear();
+    m_extents.clear();
+    m_dtypes.clear();
+    m_dtypecontexts.clear();
+    m_arrayindexes.clear();
+    m_fieldindexes.clear();
+    m_strings.clear();
+    m_symbolrows.clear();
+    m_pagetables.clear();
+    m_generator = nullptr;
+    m_count = 0;
+    m_blocks.clear();
+    m_windows.clear();
+    m_lastwindow = 0;
+    m_stale = false;
     m_fieldindex.clear();
     m_currtype.clear();
     m_indent = 0;
@@ -72,23 +384,31 @@ void Listing::pop_type() {
 
 LIndex Listing::type(RDAddress address, RDType t) {
     usize lidx = this->push_item(LISTINGITEM_TYPE, address);
-    m_items[lidx].dtype = t;
+    if(!m_counting) m_dtypes.set(lidx, t);
 
-    if(!m_items[lidx].dtype_context)
-        m_items[lidx].dtype_context = m_items[lidx].dtype;
+    bool symbol = !this->field_index() && !this->current_type();
+    if(symbol) m_symbols.push_back(lidx);
 
-    if(!this->field_index() && !this->current_type()) m_symbols.push_back(lidx);
+    if(this->check_flags(lidx, address) || symbol)
+        this->add_symbol_row(lidx, LISTINGITEM_TYPE, address, t);
 
-    this->check_flags(lidx, address);
     return lidx;
 }
 
 LIndex Listing::string(RDAddress address, usize startidx, usize n, char term,
                        RDType t) {
     LIndex lidx = this->type(address, t);
-    m_items[lidx].length = n;
-    m_items[lidx].string_index = startidx;
-    m_items[lidx].string_terminator = term;
+
+    if(const SymbolRow* r = m_symbolrows.get(lidx); r) {
+        SymbolRow sr = *r;
+        sr.string_index = startidx;
+        sr.length = n;
+        m_symbolrows.set(lidx, sr);
+    }
+
+    if(m_counting) return lidx;
+    m_extents.set(lidx, n);
+    m_strings.set(lidx, {.index = startidx, .terminator = term});
     return lidx;
 }
 
@@ -98,7 +418,10 @@ LIndex Listing::instruction(RDAddress address) {
 
 LIndex Listing::label(RDAddress address) {
     LIndex lidx = this->push_item(LISTINGITEM_LABEL, address);
-    this->check_flags(lidx, address);
+
+    if(this->check_flags(lidx, address))
+        this->add_symbol_row(lidx, LISTINGITEM_LABEL, address);
+
     return lidx;
 }
 
@@ -106,47 +429,95 @@ LIndex Listing::function(RDAddress address) {
     LIndex lidx = this->push_item(LISTINGITEM_FUNCTION, address);
     m_symbols.push_back(lidx);
     this->check_flags(lidx, address);
+    this->add_symbol_row(lidx, LISTINGITEM_FUNCTION, address);
     return lidx;
 }
 
 LIndex Listing::segment(const RDSegment* seg) {
+    this->enter_segment(seg, seg->start);
     LIndex lidx = this->push_item(LISTINGITEM_SEGMENT, seg->start);
     m_symbols.push_back(lidx);
-    m_currentsegment = seg;
+    this->add_symbol_row(lidx, LISTINGITEM_SEGMENT, seg->start);
     return lidx;
 }
 
+void Listing::enter_segment(const RDSegment* seg, RDAddress address) {
+    ct_assume(seg);
+    m_currentsegment = seg;
+    if(m_counting) return;
+
+    m_pagetables.push_back({
+        .start = address,
+        .end = seg->end,
+        .firstrow = m_addresses.size(),
+        .pages = {},
+    });
+}
+
 void Listing::hex_dump(RDAddress startaddr, RDAddress endaddr) {
     LIndex lidx = this->push_item(LISTINGITEM_HEX_DUMP, startaddr);
-    m_items[lidx].end_address = endaddr;
+    if(!m_counting) m_extents.set(lidx, endaddr);
 }
 
 void Listing::fill(RDAddress startaddr, RDAddress endaddr) {
     LIndex lidx = this->push_item(LISTINGITEM_FILL, startaddr);
-    m_items[lidx].end_address = endaddr;
+    if(!m_counting) m_extents.set(lidx, endaddr);
+}
+
+void Listing::count_rows(usize n) {
+    ct_assume(m_counting);
+    m_count += n;
+}
+
+void Listing::set_array_index(LIndex lidx, usize idx) {
+    ct_assume(lidx < this->size());
+    if(!m_counting) m_arrayindexes.set(lidx, idx);
 }
 
 LIndex Listing::push_item(RDListingItemType type, RDAddress address) {
-    LIndex idx = m_items.size();
+    if(m_counting) return m_count++;
 
-    ListingItem li{};
-    li.type = type;
-    li.address = address;
-    li.indent = m_indent;
-    li.field_index = this->field_index();
-    li.dtype_context = this->current_type();
+    LIndex idx = m_addresses.size();
+    m_types.push_back(static_cast<u8>(type));
+    m_addresses.push_back(address);
+    m_indents.push_back(static_cast<u16>(m_indent));
 
-    m_items.push_back(li);
+    if(!m_pagetables.empty()) {
+        PageTable& t = m_pagetables.back();
+        usize pidx = (address >> PAGE_BITS) - (t.start >> PAGE_BITS);
+        while(t.pages.size() <= pidx)
+            t.pages.push_back(idx);
+    }
+
+    if(auto fi = this->field_index(); fi) m_fieldindexes.set(idx, *fi);
+    if(auto ct = this->current_type(); ct) m_dtypecontexts.set(idx, *ct);
     return idx;
 }
 
-void Listing::check_flags(LIndex lidx, RDAddress address) {
+bool Listing::check_flags(LIndex lidx, RDAddress address) {
     ct_assume(m_currentsegment);
 
     if(memory::has_flag(m_currentsegment, address, BF_IMPORT))
         m_imports.push_back(lidx);
     else if(memory::has_flag(m_currentsegment, address, BF_EXPORT))
         m_exports.push_back(lidx);
+    else
+        return false;
+
+    return true;
+}
+
+void Listing::add_symbol_row(LIndex lidx, RDListingItemType type,
+                             RDAddress address, tl::optional<RDType> t) {
+    SymbolRow r{
+        .type = type,
+        .address = address,
+        .dtype = t,
+        .string_index = 0,
+        .length = 0,
+    };
+
+    m_symbolrows.set(lidx, std::move(r));
 }
 
 } // namespace redasm
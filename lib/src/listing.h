@@ -1,15 +1,20 @@
 #pragma once
 
+#include <algorithm>
 #include <deque>
+#include <functional>
+#include <memory>
 #include <redasm/listing.h>
 #include <redasm/segment.h>
 #include <redasm/types.h>
 #include <redasm/typing.h>
 #include <tl/optional.hpp>
+#include <utility>
 #include <vector>
 
 namespace redasm {
 
+// Materialized view of a single listing row
 struct ListingItem {
     RDListingItemType type;
 
@@ -37,45 +42,124 @@ struct ListingItem {
 
 class Listing {
 private:
-    using Type = std::vector<ListingItem>;
-    using ValueType = typename Type::value_type;
-    using Iterator = typename Type::iterator;
-    using ConstIterator = typename Type::const_iterator;
+    // Sparse column: (row, value) pairs sorted by row, rows are
+    // mostly appended in order so insertion is amortized O(1)
+    template<typename T>
+    class SideTable {
+    public:
+        void clear() { m_data.clear(); }
+        usize size() const { return m_data.size(); }
+
+        void set(LIndex lidx, T v) {
+            if(m_data.empty() || m_data.back().first < lidx) {
+                m_data.emplace_back(lidx, std::move(v));
+                return;
+            }
+
+            auto it = this->find_row(lidx);
+
+            if(it != m_data.end() && it->first == lidx)
+                it->second = std::move(v);
+            else
+                m_data.emplace(it, lidx, std::move(v));
+        }
+
+        void append(const SideTable& rhs, LIndex offset) {
+            for(const auto& [lidx, v] : rhs.m_data)
+                m_data.emplace_back(offset + lidx, v);
+        }
+
+        const T* get(LIndex lidx) const {
+            auto it = this->find_row(lidx);
+            if(it != m_data.end() && it->first == lidx) return &it->second;
+            return nullptr;
+        }
+
+    private:
+        auto find_row(LIndex lidx) const {
+            return std::lower_bound(
+                m_data.begin(), m_data.end(), lidx,
+                [](const auto& x, LIndex i) { return x.first < i; });
+        }
+
+        auto find_row(LIndex lidx) {
+            return std::lower_bound(
+                m_data.begin(), m_data.end(), lidx,
+                [](const auto& x, LIndex i) { return x.first < i; });
+        }
+
+    private:
+        std::vector<std::pair<LIndex, T>> m_data;
+    };
+
+    struct StringInfo {
+        usize index;
+        char terminator;
+    };
+
+    // Second level of the address index: first row of each page
+    struct PageTable {
+        RDAddress start;
+        RDAddress end;
+        LIndex firstrow;
+        std::vector<LIndex> pages;
+    };
 
     static constexpr usize INDENT = 2;
+    static constexpr usize PAGE_BITS = 12;
 
 public:
     using LIndexList = std::vector<LIndex>;
 
-    auto cbegin() const { return m_items.cbegin(); }
-    auto cend() const { return m_items.cend(); }
-    auto begin() { return m_items.begin(); }
-    auto end() { return m_items.end(); }
-    auto begin() const { return m_items.begin(); }
-    auto end() const { return m_items.end(); }
-    auto size() const { return m_items.size(); }
-    auto empty() const { return m_items.empty(); }
-    auto& front() { return m_items.front(); }
-    auto& back() { return m_items.back(); }
-    const auto& front() const { return m_items.front(); }
-    const auto& back() const { return m_items.back(); }
-    ValueType& operator[](LIndex idx) { return m_items.at(idx); }
-    const ValueType& operator[](LIndex idx) const { return m_items.at(idx); }
-
-    ConstIterator upper_bound(RDAddress address) const {
-        return this->upper_bound(address, m_items.begin());
-    }
-
-    ConstIterator lower_bound(RDAddress address) const {
-        return this->lower_bound(address, m_items.begin());
-    }
+    // Skeleton of a symbol, import or export row: symbol tables are built
+    // from these, windows are never generated
+    struct SymbolRow {
+        RDListingItemType type;
+        RDAddress address;
+        tl::optional<RDType> dtype;
+        usize string_index;
+        usize length;
+    };
+
+    // Virtual mode: a contiguous address range whose rows are generated
+    // on demand, top level items never cross block boundaries
+    struct Block {
+        const RDSegment* segment;
+        RDAddress start;
+        RDAddress end;
+        LIndex first;
+        usize count;
+    };
+
+    using Generator = std::function<void(Listing&, const Block&)>;
+
+    static constexpr usize BLOCK_SIZE = 0x4000;
+    static constexpr usize WINDOW_CACHE = 64;
+
+    usize size() const;
+    bool empty() const { return this->size() == 0; }
+    ListingItem front() const { return this->at(0); }
+    ListingItem back() const { return this->at(this->size() - 1); }
+    ListingItem operator[](LIndex idx) const { return this->at(idx); }
+    ListingItem at(LIndex idx) const;
+
+    // Dense columns, cheap to scan
+    RDAddress address_at(LIndex idx) const;
+    RDListingItemType type_at(LIndex idx) const;
+    usize indent_at(LIndex idx) const;
+
+    // Both return size() when not found
+    LIndex lower_bound(RDAddress address, LIndex start = 0) const;
+    LIndex upper_bound(RDAddress address, LIndex start = 0) const;
+
+    // First row of the item that contains 'address'
+    tl::optional<LIndex> find_row(RDAddress address) const;
 
     const LIndexList& symbols() const { return m_symbols; }
     const LIndexList& imports() const { return m_imports; }
     const LIndexList& exports() const { return m_exports; }
+    const SymbolRow* symbol_row(LIndex idx) const;
 
-    ConstIterator lower_bound(RDAddress address, ConstIterator begin) const;
-    ConstIterator upper_bound(RDAddress address, ConstIterator begin) const;
     void hex_dump(RDAddress startaddr, RDAddress endaddr);
     void fill(RDAddress startaddr, RDAddress endaddr);
     LIndex type(RDAddress address, RDType t);
@@ -85,6 +169,18 @@ public:
     LIndex label(RDAddress address);
     LIndex function(RDAddress address);
     LIndex segment(const RDSegment* seg);
+    void set_array_index(LIndex lidx, usize idx);
+
+public: // Virtual mode
+    bool is_virtual() const { return m_generator != nullptr; }
+    bool is_counting() const { return m_counting; }
+    bool is_stale() const { return m_stale; }
+    void set_counting(bool b) { m_counting = b; }
+    void count_rows(usize n);
+    void set_generator(Generator g) { m_generator = std::move(g); }
+    void add_block(const Block& b, const Listing& rows);
+    void append(const Listing& shard);
+    void enter_segment(const RDSegment* seg, RDAddress address);
 
 public: // State management functions
     tl::optional<usize> field_index() const;
@@ -100,7 +196,13 @@ public: // State management functions
 
 private:
     LIndex push_item(RDListingItemType type, RDAddress address);
-    void check_flags(LIndex lidx, RDAddress address);
+    bool check_flags(LIndex lidx, RDAddress address);
+    void add_symbol_row(LIndex lidx, RDListingItemType type, RDAddress address,
+                        tl::optional<RDType> t = tl::nullopt);
+    LIndex page_end(usize tidx, usize pidx) const;
+    usize find_block(RDAddress address) const;
+    const Listing& window(usize bidx) const;
+    const Listing& window_at(LIndex& idx) const;
 
 private:
     std::deque<usize> m_fieldindex;
@@ -108,7 +210,44 @@ private:
     const RDSegment* m_currentsegment{nullptr};
     LIndexList m_symbols, m_exports, m_imports;
     usize m_indent{0};
-    Type m_items;
+
+    // Counting mode: rows and symbols are tracked, columns are not filled
+    bool m_counting{false};
+    usize m_count{0};
+
+    // Address index, first level is sorted by segment
+    std::vector<PageTable> m_pagetables;
+
+    // Dense columns (one entry per row)
+    std::vector<u8> m_types;
+    std::vector<RDAddress> m_addresses;
+    std::vector<u16> m_indents;
+
+    // Virtual mode, windows are materialized when rows are accessed
+    struct Window {
+        usize block;
+        usize lastused;
+        std::unique_ptr<Listing> rows;
+    };
+
+    Generator m_generator;
+    std::vector<Block> m_blocks;
+    mutable std::vector<Window> m_windows;
+    mutable usize m_lastwindow{0};
+    mutable usize m_tick{0};
+
+    // A window doesn't match its block, flags changed after the skeleton
+    // was built: rows are clamped until the listing is rebuilt
+    mutable bool m_stale{false};
+
+    // Sparse columns
+    SideTable<RDAddress> m_extents; // 'end_address' or 'length'
+    SideTable<RDType> m_dtypes;
+    SideTable<RDType> m_dtypecontexts; // Nested types only, else 'dtype'
+    SideTable<usize> m_arrayindexes;
+    SideTable<usize> m_fieldindexes;
+    SideTable<StringInfo> m_strings;
+    SideTable<SymbolRow> m_symbolrows;
 };
 
 } // namespace redasm
@@ -50,7 +50,11 @@ Program::~Program() {
         delete[] segit->name;
     }
     slice_destroy(&this->segments);
+    this->clear_sregs();
+}
 
+void Program::clear_sregs() {
+    m_sreggeneration++;
     RDSRegTree *regit, *tmp;
     hmap_foreach_safe(regit, tmp, &this->segmentregs, RDSRegTree, hnode) {
         RDSRange *rangeit, *tmp;
@@ -59,6 +63,8 @@ Program::~Program() {
         }
         delete regit;
     }
+
+    hmap_init(&this->segmentregs, nullptr);
 }
 
 tl::optional<RDOffset> Program::to_offset(RDAddress address) const {
@@ -141,6 +147,7 @@ bool Program::add_sreg_range(RDAddress start, RDAddress end, int sreg,
                              u64 val) {
     if(start >= end) return false;
 
+    m_sreggeneration++;
     RDSRegTree* tree;
     hmap_get(tree, &this->segmentregs, ct_inttoptr(sreg), RDSRegTree, hnode,
              tree->sreg == sreg);
@@ -217,6 +224,7 @@ bool Program::add_sreg_range(RDAddress start, RDAddress end, int sreg,
 
 bool Program::set_sreg(RDAddress address, int sreg,
                        const RDRegValue& val) { // NOLINT
+    m_sreggeneration++;
     RDSRegTree* tree;
     hmap_get(tree, &this->segmentregs, ct_inttoptr(sreg), RDSRegTree, hnode,
              tree->sreg == sreg);
@@ -309,20 +317,53 @@ RDSegment* Program::find_segment(RDAddress address) { // NOLINT
 }
 
 Function* Program::find_function(RDAddress address) {
-    auto it = std::ranges::lower_bound(
-        this->functions, address,
-        [](RDAddress addr1, RDAddress addr2) { return addr1 < addr2; },
-        [](const redasm::Function& f) { return f.address; });
+    auto it = std::ranges::upper_bound(m_funcranges, address, {},
+                                       &FunctionRange::start);
 
-    if(it != this->functions.end() && it->contains(address))
-        return std::addressof(*it);
+    // Ranges can overlap (shared blocks): walk back while an earlier range
+    // can still reach 'address'
+    for(auto i = std::distance(m_funcranges.begin(), it); i-- > 0;) {
+        if(m_funcmaxend[i] < address) break;
 
-    if(it != this->functions.begin()) {
-        --it;
-        if(it->contains(address)) return std::addressof(*it);
+        const FunctionRange& r = m_funcranges[i];
+        if(address <= r.end) return &this->functions[r.index];
     }
 
     return nullptr;
 }
 
+Function* Program::get_function(RDAddress entry) {
+    auto it = std::ranges::lower_bound(this->functions, entry, {},
+                                       &Function::address);
+
+    if(it != this->functions.end() && it->address == entry)
+        return std::addressof(*it);
+
+    return nullptr;
+}
+
+void Program::set_functions(std::vector<Function> f) {
+    this->functions = std::move(f);
+    this->index_functions();
+}
+
+void Program::index_functions() {
+    m_funcranges.clear();
+    m_funcmaxend.clear();
+
+    for(usize i = 0; i < this->functions.size(); i++) {
+        for(const Function::BasicBlock& bb : this->functions[i].blocks)
+            m_funcranges.push_back({bb.start, bb.end, i});
+    }
+
+    std::ranges::sort(m_funcranges, {}, &FunctionRange::start);
+    m_funcmaxend.reserve(m_funcranges.size());
+    RDAddress maxend = 0;
+
+    for(const FunctionRange& r : m_funcranges) {
+        maxend = std::max(maxend, r.end);
+        m_funcmaxend.push_back(maxend);
+    }
+}
+
 } // namespace redasm
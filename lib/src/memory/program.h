@@ -26,12 +26,16 @@ struct Program {
                      u32 perm, u32 bits);
     bool add_sreg_range(RDAddress start, RDAddress end, int sreg, u64 v);
     bool set_sreg(RDAddress address, int sreg, const RDRegValue& val);
+    void clear_sregs();
     tl::optional<RDOffset> to_offset(RDAddress address) const;
     tl::optional<RDAddress> to_address(RDOffset offset) const;
     const RDSRange* find_sreg_range(RDAddress address, int sreg) const;
     RDSegment* find_segment(RDAddress address);
     RDSegment* find_segment(std::string_view name);
     Function* find_function(RDAddress address);
+    Function* get_function(RDAddress entry);
+    void set_functions(std::vector<Function> f);
+    [[nodiscard]] usize sreg_generation() const { return m_sreggeneration; }
 
     const RDSegment* find_segment(std::string_view name) const {
         return const_cast<Program*>(this)->find_segment(name);
@@ -45,11 +49,28 @@ struct Program {
         return const_cast<Program*>(this)->find_function(address);
     }
 
+    const Function* get_function(RDAddress entry) const {
+        return const_cast<Program*>(this)->get_function(entry);
+    }
+
     std::vector<FileMapping> mappings;
     RDSegmentSlice segments;
     std::vector<Function> functions;
     RDSRangeMap segmentregs;
     RDBuffer* file;
+
+private:
+    struct FunctionRange {
+        RDAddress start, end;
+        usize index; // 'functions' index
+    };
+
+    void index_functions();
+
+private:
+    std::vector<FunctionRange> m_funcranges; // Sorted by start
+    std::vector<RDAddress> m_funcmaxend;     // Prefix maximum of ends
+    usize m_sreggeneration{0};               // Bumped on every sreg change
 };
 
 } // namespace redasm
@@ -0,0 +1,138 @@
+#include "problemstore.h"
+#include <spdlog/spdlog.h>
+
+namespace redasm {
+
+namespace {
+
+std::string_view get_refname(usize reftype) {
+    switch(reftype) {
+        case DR_READ: return "READ";
+        case DR_WRITE: return "WRITE";
+        case DR_ADDRESS: return "ADDRESS";
+        case CR_JUMP: return "JUMP";
+        case CR_CALL: return "CALL";
+        default: break;
+    }
+
+    ct_unreachable;
+}
+
+} // namespace
+
+usize ProblemStore::ProblemHash::operator()(const Problem& p) const {
+    usize h = std::hash<RDAddress>{}(p.address);
+    h ^= std::hash<usize>{}(p.code) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= std::hash<u64>{}(p.arg) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= std::hash<const char*>{}(p.s.data()) + 0x9e3779b9 + (h << 6) +
+         (h >> 2);
+    return h;
+}
+
+ProblemStore::ProblemStore() {
+    slice_init(&m_slice, nullptr, nullptr);
+
+    for(usize i = 0; i < m_counts.size(); i++)
+        m_counts[i].code = i;
+}
+
+ProblemStore::~ProblemStore() { slice_destroy(&m_slice); }
+
+void ProblemStore::add(RDAddress address, usize code, u64 arg,
+                       std::string_view s) {
+    ct_assume(code < PROBLEM_COUNT);
+    RDProblemCount& c = m_counts[code];
+    c.count++;
+
+    if(c.stored >= m_limit) return;
+    if(!s.empty()) s = *m_strings.emplace(s).first;
+
+    Problem p{.address = address, .code = code, .arg = arg, .s = s};
+    if(!m_seen.insert(p).second) return; // Duplicate
+
+    c.stored++;
+    m_problems.push_back(p);
+
+    // Messages are formatted on read, see get_problems()
+    spdlog::trace("add_problem(): {:x} = #{}", address, code);
+
+    if(c.stored == m_limit) {
+        spdlog::warn("add_problem(): limit reached for problem code {}, "
+                     "further occurrences will be counted only",
+                     code);
+    }
+}
+
+const RDProblemSlice* ProblemStore::get_problems() const {
+    // Format new problems only
+    for(usize i = slice_length(&m_slice); i < m_problems.size(); i++) {
+        const Problem& p = m_problems[i];
+        const std::string& msg =
+            m_messages.emplace_back(ProblemStore::format(p));
+
+        slice_push(&m_slice, {
+                                 .address = p.address,
+                                 .problem = msg.c_str(),
+                                 .code = p.code,
+                             });
+    }
+
+    return &m_slice;
+}
+
+usize ProblemStore::get_counts(const RDProblemCount** counts) const {
+    m_activecounts.clear();
+
+    for(const RDProblemCount& c : m_counts) {
+        if(c.count) m_activecounts.push_back(c);
+    }
+
+    if(counts) *counts = m_activecounts.data();
+    return m_activecounts.size();
+}
+
+std::string ProblemStore::format(const Problem& p) {
+    switch(p.code) {
+        case PROBLEM_CUSTOM: return std::string{p.s};
+        case PROBLEM_INVALID_FUNCTION: return "Invalid function location";
+        case PROBLEM_INVALID_ENTRY: return "Invalid entry location";
+
+        case PROBLEM_INVALID_FROM_REF:
+            return fmt::format("Invalid FROM {} reference",
+                               get_refname(p.arg));
+
+        case PROBLEM_INVALID_TO_REF:
+            return fmt::format("Invalid TO {} reference", get_refname(p.arg));
+
+        case PROBLEM_NONCODE_SEGMENT:
+            return fmt::format("Trying to {} in non-code segment '{}'",
+                               get_refname(p.arg), p.s);
+
+        case PROBLEM_OUTSIDE_SEGMENTS:
+            return fmt::format("Trying to {} outside of segments",
+                               get_refname(p.arg));
+
+        case PROBLEM_NAME_OUT_OF_BOUNDS:
+            return "Cannot set name, address out of bounds";
+
+        case PROBLEM_NAME_ALREADY_SET:
+            return fmt::format("Name already set @ {:x} (trying to set '{}')",
+                               p.address, p.s);
+
+        case PROBLEM_NAME_EXISTS:
+            return fmt::format("name '{}' already exists", p.s);
+
+        case PROBLEM_DELAY_SLOT:
+            return fmt::format("Cannot decode delay slot #{}", p.arg);
+
+        case PROBLEM_DECODE_NOT_IMPLEMENTED:
+            return fmt::format("decode() not implemented for processor '{}'",
+                               p.s);
+
+        default: break;
+    }
+
+    ct_unreachable;
+}
+
+} // namespace redasm
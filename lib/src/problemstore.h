@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <redasm/redasm.h>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace redasm {
+
+class ProblemStore {
+    struct Problem {
+        RDAddress address;
+        usize code;
+        u64 arg;
+        std::string_view s; // Interned
+
+        bool operator==(const Problem&) const = default;
+    };
+
+    struct ProblemHash {
+        usize operator()(const Problem& p) const;
+    };
+
+public:
+    static constexpr usize DEFAULT_LIMIT = 1000; // Per problem code
+
+    ProblemStore();
+    ~ProblemStore();
+    void add(RDAddress address, usize code, u64 arg = 0,
+             std::string_view s = {});
+    void set_limit(usize n) { m_limit = n; }
+    const RDProblemSlice* get_problems() const;
+    usize get_counts(const RDProblemCount** counts) const;
+
+private:
+    static std::string format(const Problem& p);
+
+private:
+    std::vector<Problem> m_problems;
+    std::unordered_set<Problem, ProblemHash> m_seen;
+    std::unordered_set<std::string> m_strings;
+    std::array<RDProblemCount, PROBLEM_COUNT> m_counts{};
+    usize m_limit{DEFAULT_LIMIT};
+
+    // Lazily formatted messages
+    mutable std::deque<std::string> m_messages;
+    mutable RDProblemSlice m_slice;
+    mutable std::vector<RDProblemCount> m_activecounts;
+};
+
+} // namespace redasm
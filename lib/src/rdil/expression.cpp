@@ -1,9 +1,16 @@
 #include "expression.h"
+#include <algorithm>
+#include <cstring>
 
 namespace redasm::rdil {
 
-const RDILExpr* ILExprPool::expr_unknown() { return this->expr(RDIL_UNKNOWN); }
-const RDILExpr* ILExprPool::expr_nop() { return this->expr(RDIL_NOP); }
+const RDILExpr* ILExprPool::expr_unknown() {
+    return this->intern(this->expr(RDIL_UNKNOWN));
+}
+
+const RDILExpr* ILExprPool::expr_nop() {
+    return this->intern(this->expr(RDIL_NOP));
+}
 
 const RDILExpr* ILExprPool::expr_pop(const RDILExpr* e) {
     return this->expr_u(RDIL_POP, e);
@@ -14,27 +21,27 @@ const RDILExpr* ILExprPool::expr_push(const RDILExpr* e) {
 }
 
 const RDILExpr* ILExprPool::expr_reg(int reg) {
-    RDILExpr* expr = this->expr(RDIL_REG);
-    expr->reg = reg;
-    return expr;
+    RDILExpr expr = this->expr(RDIL_REG);
+    expr.reg = reg;
+    return this->intern(expr);
 }
 
 const RDILExpr* ILExprPool::expr_sym(const char* sym) {
-    RDILExpr* expr = this->expr(RDIL_SYM);
-    expr->sym = sym;
-    return expr;
+    RDILExpr expr = this->expr(RDIL_SYM);
+    expr.sym = sym;
+    return this->intern(expr);
 }
 
 const RDILExpr* ILExprPool::expr_cnst(u64 value) {
-    RDILExpr* expr = this->expr(RDIL_CNST);
-    expr->u_cnst = value;
-    return expr;
+    RDILExpr expr = this->expr(RDIL_CNST);
+    expr.u_cnst = value;
+    return this->intern(expr);
 }
 
 const RDILExpr* ILExprPool::expr_var(RDAddress address) {
-    RDILExpr* expr = this->expr(RDIL_VAR);
-    expr->addr = address;
-    return expr;
+    RDILExpr expr = this->expr(RDIL_VAR);
+    expr.addr = address;
+    return this->intern(expr);
 }
 
 const RDILExpr* ILExprPool::expr_goto(const RDILExpr* e) {
@@ -120,11 +127,11 @@ const RDILExpr* ILExprPool::expr_copy(const RDILExpr* dst,
 
 const RDILExpr* ILExprPool::expr_if(const RDILExpr* cond, const RDILExpr* t,
                                     const RDILExpr* f) {
-    RDILExpr* expr = this->expr(RDIL_IF);
-    expr->cond = this->check(cond);
-    expr->t = this->check(t);
-    expr->f = this->check(f);
-    return expr;
+    RDILExpr expr = this->expr(RDIL_IF);
+    expr.cond = this->check(cond);
+    expr.t = this->check(t);
+    expr.f = this->check(f);
+    return this->intern(expr);
 }
 
 const RDILExpr* ILExprPool::expr_eq(const RDILExpr* l, const RDILExpr* r) {
@@ -159,32 +166,99 @@ const RDILExpr* ILExprPool::check(const RDILExpr* e) {
     return e ? e : this->expr_unknown();
 }
 
-RDILExpr* ILExprPool::expr_ds(RDILOp op, const RDILExpr* dst,
-                              const RDILExpr* src) {
-    RDILExpr* expr = this->expr(op);
-    expr->dst = this->check(dst);
-    expr->src = this->check(src);
-    return expr;
+const RDILExpr* ILExprPool::expr_ds(RDILOp op, const RDILExpr* dst,
+                                    const RDILExpr* src) {
+    RDILExpr expr = this->expr(op);
+    expr.dst = this->check(dst);
+    expr.src = this->check(src);
+    return this->intern(expr);
 }
 
-RDILExpr* ILExprPool::expr_lr(RDILOp op, const RDILExpr* l, const RDILExpr* r) {
-    RDILExpr* expr = this->expr(op);
-    expr->l = this->check(l);
-    expr->r = this->check(r);
-    return expr;
+const RDILExpr* ILExprPool::expr_lr(RDILOp op, const RDILExpr* l,
+                                    const RDILExpr* r) {
+    RDILExpr expr = this->expr(op);
+    expr.l = this->check(l);
+    expr.r = this->check(r);
+    return this->intern(expr);
 }
 
-RDILExpr* ILExprPool::expr_u(RDILOp op, const RDILExpr* u) {
-    RDILExpr* expr = this->expr(op);
-    expr->u = this->check(u);
-    return expr;
+const RDILExpr* ILExprPool::expr_u(RDILOp op, const RDILExpr* u) {
+    RDILExpr expr = this->expr(op);
+    expr.u = this->check(u);
+    return this->intern(expr);
 }
 
-RDILExpr* ILExprPool::expr(RDILOp op) {
-    auto& expr = m_pool.emplace_front(RDILExpr{});
+RDILExpr ILExprPool::expr(RDILOp op) const {
+    RDILExpr expr{};
     expr.address = this->currentaddress;
     expr.op = op;
-    return &expr;
+    return expr;
+}
+
+const RDILExpr* ILExprPool::intern(const RDILExpr& e) {
+    if((m_count + 1) * 2 > m_slots.size()) this->grow();
+
+    ExprKey k = ILExprPool::get_key(e);
+    usize mask = m_slots.size() - 1;
+
+    for(usize i = ILExprPool::get_hash(k) & mask;; i = (i + 1) & mask) {
+        Slot& slot = m_slots[i];
+
+        if(slot.generation != m_generation) {
+            auto* p = reinterpret_cast<RDILExpr*>(
+                m_arena.allocate(sizeof(RDILExpr)));
+
+            *p = e;
+            slot = {p, m_generation};
+            m_count++;
+            return p;
+        }
+
+        if(ILExprPool::get_key(*slot.expr) == k) return slot.expr;
+    }
+}
+
+void ILExprPool::grow() {
+    std::vector<Slot> old;
+    old.swap(m_slots);
+    m_slots.resize(std::max<usize>(old.size() * 2, 64));
+
+    usize mask = m_slots.size() - 1;
+
+    for(const Slot& slot : old) {
+        if(slot.generation != m_generation) continue;
+
+        usize i = ILExprPool::get_hash(ILExprPool::get_key(*slot.expr)) & mask;
+        while(m_slots[i].generation == m_generation)
+            i = (i + 1) & mask;
+
+        m_slots[i] = slot;
+    }
+}
+
+void ILExprPool::reset() {
+    m_generation++;
+    m_count = 0;
+    m_arena.reset();
+}
+
+ILExprPool::ExprKey ILExprPool::get_key(const RDILExpr& e) {
+    // Operand unions are compared bitwise: children are already unique,
+    // so structural equality reduces to pointer equality
+    ExprKey k{e.address, static_cast<u64>(e.op)};
+    std::memcpy(&k[2], &e.n1, sizeof(u64));
+    std::memcpy(&k[3], &e.n2, sizeof(u64));
+    std::memcpy(&k[4], &e.n3, sizeof(u64));
+    return k;
+}
+
+usize ILExprPool::get_hash(const ExprKey& k) {
+    // Independent multiplies, this runs once per created expression
+    u64 h = (k[0] * 0x9e3779b97f4a7c15ull) ^ (k[1] * 0xbf58476d1ce4e5b9ull) ^
+            (k[2] * 0x94d049bb133111ebull) ^ (k[3] * 0xd6e8feb86659fd93ull) ^
+            (k[4] * 0xff51afd7ed558ccdull);
+
+    return h ^ (h >> 29);
 }
 
 } // namespace redasm::rdil
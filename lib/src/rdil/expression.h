@@ -1,15 +1,28 @@
 #pragma once
 
-#include <forward_list>
+#include "../surface/framearena.h"
+#include <array>
 #include <redasm/rdil.h>
+#include <vector>
 
 namespace redasm::rdil {
 
+// Expressions are hash-consed: building the same expression twice at the
+// same address returns the same pointer
 class ILExprPool {
 private:
-    using Pool = std::forward_list<RDILExpr>;
+    using ExprKey = std::array<u64, 5>;
+
+    // Open addressing slot, stale when 'generation' doesn't match the pool's
+    struct Slot {
+        const RDILExpr* expr;
+        usize generation;
+    };
 
 public:
+    // Invalidates every expression in O(1), the arena memory is kept
+    void reset();
+
     const RDILExpr* expr_unknown();
     const RDILExpr* expr_nop();
     const RDILExpr* expr_pop(const RDILExpr* e);
@@ -52,16 +65,26 @@ protected:
     const RDILExpr* check(const RDILExpr* e);
 
 private:
-    RDILExpr* expr_ds(RDILOp op, const RDILExpr* dst, const RDILExpr* src);
-    RDILExpr* expr_lr(RDILOp op, const RDILExpr* l, const RDILExpr* r);
-    RDILExpr* expr_u(RDILOp op, const RDILExpr* u);
-    RDILExpr* expr(RDILOp op);
+    static ExprKey get_key(const RDILExpr& e);
+    static usize get_hash(const ExprKey& k);
+    void grow();
+    const RDILExpr* expr_ds(RDILOp op, const RDILExpr* dst,
+                            const RDILExpr* src);
+    const RDILExpr* expr_lr(RDILOp op, const RDILExpr* l, const RDILExpr* r);
+    const RDILExpr* expr_u(RDILOp op, const RDILExpr* u);
+    const RDILExpr* intern(const RDILExpr& e);
+    RDILExpr expr(RDILOp op) const;
 
 public:
     RDAddress currentaddress{};
 
 private:
-    Pool m_pool;
+    // Most functions lift to a few dozen expressions, start small
+    static constexpr usize ARENA_FIRST_BLOCK = 32 * sizeof(RDILExpr);
+
+    FrameArena m_arena{ARENA_FIRST_BLOCK};
+    std::vector<Slot> m_slots; // Power of two
+    usize m_generation{1}, m_count{0};
 };
 
 } // namespace redasm::rdil
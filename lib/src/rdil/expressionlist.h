@@ -19,6 +19,12 @@ public:
     usize size() const { return m_expressions.size(); }
     void clear() { m_expressions.clear(); }
 
+    // Drops both the list and its pool, for lists reused across decodes
+    void reset() {
+        m_expressions.clear();
+        ILExprPool::reset();
+    }
+
 public:
     Container::iterator begin() { return m_expressions.begin(); }
     Container::iterator end() { return m_expressions.end(); }
@@ -0,0 +1,134 @@
+#include "ilcache.h"
+#include "../context.h"
+#include "../memory/memory.h"
+#include "../memory/program.h"
+#include "../state.h"
+#include "rdil.h"
+#include <algorithm>
+
+namespace redasm::rdil {
+
+namespace {
+
+// Annotations don't change how an instruction is lifted
+constexpr RDMByte ANNOTATION_FLAGS = BF_NAME | BF_COMMENT | BF_REFSTO |
+                                     BF_REFSFROM | BF_IMPORT | BF_EXPORT;
+
+} // namespace
+
+ILFunction::ILFunction(const Function& f, u64 fingerprint, usize sreggen)
+    : m_fingerprint{fingerprint}, m_sreggen{sreggen} {
+    rdil::generate(f, m_exprs);
+
+    m_byaddress.assign(m_exprs.begin(), m_exprs.end());
+    std::ranges::stable_sort(m_byaddress, {}, &RDILExpr::address);
+}
+
+std::span<const RDILExpr* const> ILFunction::at(RDAddress address) const {
+    auto [first, last] =
+        std::ranges::equal_range(m_byaddress, address, {}, &RDILExpr::address);
+    return {first, last};
+}
+
+std::shared_ptr<const ILFunction> ILCache::get(const Function& f) {
+    const Context* ctx = state::context;
+    ct_assume(ctx);
+
+    usize rev = ctx->revision();
+    usize sreggen = ctx->program.sreg_generation();
+
+    std::scoped_lock lock{m_mutex};
+    auto it = m_cache.find(f.address);
+
+    if(it == m_cache.end()) {
+        m_lru.push_front(f.address);
+        it = m_cache.emplace(f.address, Entry{{}, 0, 0, m_lru.begin()}).first;
+
+        if(m_cache.size() > ILCache::CACHE_SIZE) {
+            m_cache.erase(m_lru.back());
+            m_lru.pop_back();
+        }
+    }
+    else
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+
+    Entry& e = it->second;
+
+    if(e.function && e.revision == rev &&
+       e.function->sreg_generation() == sreggen)
+        return e.function;
+
+    u64 fp = ILCache::fingerprint(f);
+
+    if(!e.function || e.function->fingerprint() != fp ||
+       e.function->sreg_generation() != sreggen) {
+        e.function = std::make_shared<const ILFunction>(f, fp, sreggen);
+        e.ranges = ILCache::ranges(f);
+    }
+
+    e.revision = rev;
+    return e.function;
+}
+
+void ILCache::invalidate(const Program& p) {
+    std::scoped_lock lock{m_mutex};
+
+    for(auto it = m_cache.begin(); it != m_cache.end();) {
+        const Function* f = p.get_function(it->first);
+
+        if(!f || ILCache::ranges(*f) != it->second.ranges) {
+            m_lru.erase(it->second.lru);
+            it = m_cache.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void ILCache::clear() {
+    std::scoped_lock lock{m_mutex};
+    m_cache.clear();
+    m_lru.clear();
+}
+
+u64 ILCache::ranges(const Function& f) {
+    u64 h = 0xcbf29ce484222325ull;
+
+    for(const Function::BasicBlock& bb : f.blocks) {
+        h = (h ^ bb.start) * 0x100000001b3ull;
+        h = (h ^ bb.end) * 0x100000001b3ull;
+    }
+
+    return h;
+}
+
+u64 ILCache::fingerprint(const Function& f) {
+    const Context* ctx = state::context;
+    u64 h = 0xcbf29ce484222325ull;
+
+    auto mix = [&h](u64 v) {
+        h ^= v;
+        h *= 0x100000001b3ull;
+    };
+
+    // Memory bytes carry both the value and the flags
+    for(const Function::BasicBlock& bb : f.blocks) {
+        const RDSegment* seg = ctx->program.find_segment(bb.start);
+        if(!seg) continue;
+
+        // 'end' is the last instruction, include all of its bytes
+        RDAddress end = std::min<RDAddress>(
+            bb.end + std::max<usize>(memory::get_length(seg, bb.end), 1),
+            seg->end);
+
+        mix(bb.start);
+        mix(bb.end);
+
+        for(RDAddress a = bb.start; a < end; a++)
+            mix(seg->mem->m_data[a - seg->start] & ~ANNOTATION_FLAGS);
+    }
+
+    return h;
+}
+
+} // namespace redasm::rdil
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../disasm/function.h"
+#include "expressionlist.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace redasm {
+
+struct Program;
+
+namespace rdil {
+
+// Lifted form of a function, shared between analyzers, the RDIL surface
+// mode and plugins
+class ILFunction {
+public:
+    ILFunction(const Function& f, u64 fingerprint, usize sreggen);
+    [[nodiscard]] const ILExprList& expressions() const { return m_exprs; }
+    [[nodiscard]] u64 fingerprint() const { return m_fingerprint; }
+    [[nodiscard]] usize sreg_generation() const { return m_sreggen; }
+
+    // Expressions lifted from the instruction at 'address'
+    [[nodiscard]] std::span<const RDILExpr* const> at(RDAddress address) const;
+
+private:
+    ILExprList m_exprs;
+    std::vector<const RDILExpr*> m_byaddress; // Stable sorted by address
+    u64 m_fingerprint;
+    usize m_sreggen;
+};
+
+// Per-function LRU cache, an entry is lifted again when the bytes or flags
+// in the function's blocks, or any segment register, change.
+// Fingerprints are only recomputed when the context revision changes
+class ILCache {
+    struct Entry {
+        std::shared_ptr<const ILFunction> function;
+        usize revision;
+        u64 ranges; // Block layout when it was lifted
+        std::list<RDAddress>::iterator lru;
+    };
+
+public:
+    static constexpr usize CACHE_SIZE = 256;
+
+    std::shared_ptr<const ILFunction> get(const Function& f);
+
+    // Drops the entries whose function is gone or has different blocks
+    void invalidate(const Program& p);
+    void clear();
+
+private:
+    static u64 fingerprint(const Function& f);
+    static u64 ranges(const Function& f);
+
+private:
+    std::unordered_map<RDAddress, Entry> m_cache;
+    std::list<RDAddress> m_lru; // Most recent first
+    std::mutex m_mutex;
+};
+
+} // namespace rdil
+
+} // namespace redasm
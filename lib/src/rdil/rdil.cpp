@@ -418,6 +418,7 @@ void decode(RDAddress address, ILExprList& res) {
     ct_assume(p);
 
     ctx->worker->emulator.reset();
+    res.currentaddress = address;
 
     RDInstruction instr;
     bool ok = ctx->worker->emulator.decode(address, instr);
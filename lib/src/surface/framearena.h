@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <redasm/types.h>
+#include <string_view>
+#include <vector>
+
+namespace redasm {
+
+// Bump allocator for temporaries that live until the end of a frame,
+// memory is retained across reset() calls.
+// Blocks start at 'firstblock' bytes and double up to BLOCK_SIZE
+class FrameArena {
+    struct Block {
+        std::unique_ptr<char[]> data;
+        usize size;
+    };
+
+public:
+    static constexpr usize BLOCK_SIZE = 0x4000;
+
+    explicit FrameArena(usize firstblock = BLOCK_SIZE)
+        : m_nextblock{std::min(firstblock, BLOCK_SIZE)} {}
+
+    char* allocate(usize n) {
+        while(m_curr < m_blocks.size()) {
+            Block& b = m_blocks[m_curr];
+
+            if(m_offset + n <= b.size) {
+                char* p = b.data.get() + m_offset;
+                m_offset += n;
+                return p;
+            }
+
+            m_curr++;
+            m_offset = 0;
+        }
+
+        usize sz = std::max(n, m_nextblock);
+        m_blocks.push_back({std::make_unique<char[]>(sz), sz});
+        m_nextblock = std::min(m_nextblock * 2, BLOCK_SIZE);
+        m_offset = n;
+        return m_blocks.back().data.get();
+    }
+
+    std::string_view copy(std::string_view s) {
+        if(s.empty()) return {};
+        char* p = this->allocate(s.size());
+        std::memcpy(p, s.data(), s.size());
+        return {p, s.size()};
+    }
+
+    // Shrinks the last allocation 'p' to 'n' bytes
+    void shrink(const char* p, usize n) {
+        ct_assume(m_curr < m_blocks.size());
+        m_offset = static_cast<usize>(p - m_blocks[m_curr].data.get()) + n;
+    }
+
+    void reset() {
+        m_curr = 0;
+        m_offset = 0;
+    }
+
+private:
+    std::vector<Block> m_blocks;
+    usize m_nextblock, m_curr{0}, m_offset{0};
+};
+
+} // namespace redasm
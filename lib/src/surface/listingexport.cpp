@@ -0,0 +1,110 @@
+#include "listingexport.h"
+#include "../context.h"
+#include "../state.h"
+#include "surface.h"
+#include <fstream>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <redasm/redasm.h>
+#include <spdlog/spdlog.h>
+#include <string>
+
+namespace redasm::listingexport {
+
+namespace {
+
+// Listing items rendered before they are written to disk
+constexpr usize CHUNK_SIZE = 0x1000;
+
+void write_text(const SurfaceRows& rows, std::string& out) {
+    for(const SurfaceRow& row : rows) {
+        for(const RDSurfaceCell& c : row.cells)
+            out.push_back(c.ch);
+
+        out.push_back('\n');
+    }
+}
+
+void write_jsonl(const SurfaceRows& rows, std::string& out) {
+    const Listing& lst = state::context->listing;
+    rapidjson::StringBuffer sb;
+    std::string token;
+
+    for(const SurfaceRow& row : rows) {
+        sb.Clear();
+        rapidjson::Writer<rapidjson::StringBuffer> w{sb};
+
+        w.StartObject();
+        w.Key("address");
+        w.Uint64(lst.address_at(row.listingindex));
+        w.Key("tokens");
+        w.StartArray();
+
+        // Adjacent cells with the same theme are merged into one token
+        for(usize i = 0; i < row.cells.size();) {
+            RDThemeKind fg = row.cells[i].fg;
+            token.clear();
+
+            for(; i < row.cells.size() && row.cells[i].fg == fg; i++)
+                token.push_back(row.cells[i].ch);
+
+            w.StartObject();
+            w.Key("text");
+            w.String(token.data(), token.size());
+            w.Key("theme");
+            w.Uint(fg);
+            w.EndObject();
+        }
+
+        w.EndArray();
+        w.EndObject();
+
+        out.append(sb.GetString(), sb.GetSize());
+        out.push_back('\n');
+    }
+}
+
+void render_chunk(Surface& sf, LIndex start, usize flags, std::string& out) {
+    sf.render_rows(start, CHUNK_SIZE);
+
+    if(flags & EXPORT_JSONL)
+        write_jsonl(sf.rows, out);
+    else
+        write_text(sf.rows, out);
+}
+
+} // namespace
+
+bool save(std::string_view filepath, usize flags) {
+    const Context* ctx = state::context;
+    if(!ctx) return false;
+
+    std::ofstream ofs{std::string{filepath},
+                      std::ios::binary | std::ios::trunc};
+
+    if(!ofs.is_open()) {
+        spdlog::error("Export: cannot write '{}'", filepath);
+        return false;
+    }
+
+    usize sflags = SURFACE_TEXT;
+    if(flags & EXPORT_RDIL) sflags |= SURFACE_RDIL;
+
+    // Rendering decodes, lifts and queries the database through shared
+    // state (processor, emulator, problem store): chunks are rendered in
+    // order by a single surface, its buffers are reused
+    const Listing& lst = ctx->listing;
+    Surface sf{sflags};
+    std::string out;
+
+    for(LIndex start = 0; start < lst.size(); start += CHUNK_SIZE) {
+        out.clear();
+        render_chunk(sf, start, flags, out);
+        ofs.write(out.data(), out.size());
+    }
+
+    spdlog::info("Exported {} listing items to '{}'", lst.size(), filepath);
+    return ofs.good();
+}
+
+} // namespace redasm::listingexport
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <redasm/types.h>
+#include <string_view>
+
+namespace redasm::listingexport {
+
+bool save(std::string_view filepath, usize flags);
+
+} // namespace redasm::listingexport
@@ -0,0 +1,110 @@
+#include "prefetch.h"
+#include "../context.h"
+#include "../memory/memory.h"
+#include "../state.h"
+#include <algorithm>
+
+namespace redasm {
+
+namespace {
+
+// Rows are kept only when the address flags them, like Context does
+bool has_flag(const Context* ctx, RDAddress address, u32 f) {
+    const RDSegment* seg = ctx->program.find_segment(address);
+    return seg && memory::has_flag(seg, address, f);
+}
+
+} // namespace
+
+void Prefetch::clear() {
+    m_refsfromaddr.clear();
+    m_refsfrom.clear();
+    m_names.clear();
+    m_comments.clear();
+    m_arena.reset();
+    m_valid = false;
+}
+
+void Prefetch::fetch(RDAddress start, RDAddress end) {
+    const Context* ctx = state::context;
+    ct_assume(ctx);
+    ct_assume(start <= end);
+
+    this->clear();
+
+    Database::RangeRefList refs = ctx->get_refs_from_range(start, end);
+
+    // Refs of the same address keep the database order
+    if(!std::ranges::is_sorted(refs, {}, &Database::RangeRef::fromaddr))
+        std::ranges::stable_sort(refs, {}, &Database::RangeRef::fromaddr);
+
+    for(const Database::RangeRef& r : refs) {
+        if(!has_flag(ctx, r.fromaddr, BF_REFSFROM)) continue;
+        m_refsfromaddr.push_back(r.fromaddr);
+        m_refsfrom.push_back({.address = r.toaddr, .type = r.type});
+    }
+
+    for(const auto& [address, comment] : ctx->get_comments_range(start, end)) {
+        if(has_flag(ctx, address, BF_COMMENT))
+            m_comments.emplace_back(address, m_arena.copy(comment));
+    }
+
+    // Cleared names are stored as empty strings
+    for(const auto& [address, name] : ctx->get_names_range(start, end)) {
+        if(!name.empty() && has_flag(ctx, address, BF_NAME))
+            m_names.emplace_back(address, m_arena.copy(name));
+    }
+
+    std::ranges::sort(m_comments, {}, &Strings::value_type::first);
+    std::ranges::sort(m_names, {}, &Strings::value_type::first);
+
+    m_start = start;
+    m_end = end;
+    m_valid = true;
+}
+
+bool Prefetch::contains(RDAddress address) const {
+    return m_valid && address >= m_start && address <= m_end;
+}
+
+bool Prefetch::contains(RDAddress start, RDAddress end) const {
+    return this->contains(start) && this->contains(end);
+}
+
+std::string_view Prefetch::get_name(RDAddress address) const {
+    if(this->contains(address)) {
+        if(std::string_view n = Prefetch::find_string(m_names, address);
+           !n.empty())
+            return n;
+    }
+
+    // Automatic names are built by Context
+    return m_arena.copy(state::context->get_name(address));
+}
+
+std::string_view Prefetch::get_comment(RDAddress address) const {
+    if(!this->contains(address))
+        return m_arena.copy(state::context->get_comment(address));
+
+    return Prefetch::find_string(m_comments, address);
+}
+
+std::span<const RDRef> Prefetch::get_refs_from(RDAddress fromaddr) const {
+    if(!this->contains(fromaddr)) {
+        m_refsfallback = state::context->get_refs_from(fromaddr);
+        return m_refsfallback;
+    }
+
+    auto [first, last] = std::ranges::equal_range(m_refsfromaddr, fromaddr);
+    usize idx = std::distance(m_refsfromaddr.begin(), first);
+    return {m_refsfrom.data() + idx, static_cast<usize>(last - first)};
+}
+
+std::string_view Prefetch::find_string(const Strings& s, RDAddress address) {
+    auto it =
+        std::ranges::lower_bound(s, address, {}, &Strings::value_type::first);
+    if(it != s.end() && it->first == address) return it->second;
+    return {};
+}
+
+} // namespace redasm
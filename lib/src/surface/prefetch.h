@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../database/database.h"
+#include "framearena.h"
+#include <redasm/types.h>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redasm {
+
+// Frame local copy of the database rows needed to render an address range,
+// lookups outside the fetched range are forwarded to Context.
+// Rows are kept in flat sorted arrays, their storage is reused by every
+// fetch(). Returned views are valid until the next clear() or fetch(),
+// forwarded refs until the next get_refs_from()
+class Prefetch {
+    using Strings = std::vector<std::pair<RDAddress, std::string_view>>;
+
+public:
+    void clear();
+    void fetch(RDAddress start, RDAddress end);
+    bool contains(RDAddress address) const;
+    bool contains(RDAddress start, RDAddress end) const;
+    std::string_view get_name(RDAddress address) const;
+    std::string_view get_comment(RDAddress address) const;
+    std::span<const RDRef> get_refs_from(RDAddress fromaddr) const;
+
+private:
+    static std::string_view find_string(const Strings& s, RDAddress address);
+
+private:
+    std::vector<RDAddress> m_refsfromaddr; // Sorted, one per 'm_refsfrom'
+    std::vector<RDRef> m_refsfrom;
+    mutable Database::RefList m_refsfallback;
+    Strings m_names, m_comments;
+    mutable FrameArena m_arena; // Prefetched strings and Context fallbacks
+    RDAddress m_start{0}, m_end{0};
+    bool m_valid{false};
+};
+
+} // namespace redasm
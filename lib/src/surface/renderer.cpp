@@ -12,10 +12,19 @@ namespace redasm {
 namespace {
 
 template<typename T>
-std::string_view render_int(T val, int base) {
+std::string_view format_int(FrameArena& a, T val, int base, bool sign = false,
+                            int bits = 0) {
+    char* p = a.allocate(utils::INT_CHARS);
+    usize n = utils::to_chars(p, val, base, sign, bits);
+    a.shrink(p, n);
+    return {p, n};
+}
+
+template<typename T>
+std::string_view render_int(FrameArena& a, T val, int base) {
     constexpr int W = sizeof(T) * 2;
     constexpr bool SIGN = std::is_signed_v<T>;
-    return utils::to_string(val, base, SIGN, W);
+    return format_int(a, val, base, SIGN, W);
 }
 
 } // namespace
@@ -43,7 +52,8 @@ void Renderer::highlight_row(int row) {
 void Renderer::highlight_words(int row, int col) {
     if(this->has_flag(SURFACE_NOHIGHLIGHT)) return;
 
-    std::string word = Renderer::word_at(m_rows, row, col);
+    std::string& word = m_word;
+    Renderer::word_at(m_rows, row, col, word);
     if(word.empty()) return;
 
     for(SurfaceRow& row : m_rows) {
@@ -127,6 +137,43 @@ void Renderer::set_current_item(LIndex lidx, const ListingItem& item) {
     this->check_current_segment(item);
 }
 
+void Renderer::clear() {
+    for(SurfaceRow& row : m_rows) {
+        row.cells.clear();
+        m_cellpool.push_back(std::move(row.cells));
+    }
+
+    m_rows.clear();
+    this->autocolumns = 0;
+    this->arena.reset();
+}
+
+SurfaceRow& Renderer::push_row(LIndex lidx) {
+    this->prevmnemonic = false;
+
+    if(!this->columns && !m_rows.empty()) {
+        this->autocolumns =
+            std::max(this->autocolumns, m_rows.back().cells.size());
+    }
+
+    SurfaceRow& row = m_rows.emplace_back(SurfaceRow{
+        .listingindex = lidx,
+        .cells = {},
+    });
+
+    if(!m_cellpool.empty()) {
+        row.cells = std::move(m_cellpool.back());
+        m_cellpool.pop_back();
+    }
+
+    return row;
+}
+
+void Renderer::append_row(const SurfaceRow& row) {
+    SurfaceRow& r = this->push_row(row.listingindex);
+    r.cells.assign(row.cells.begin(), row.cells.end());
+}
+
 Renderer& Renderer::instr() {
     const Context* ctx = state::context;
     const RDProcessorPlugin* p = ctx->processorplugin;
@@ -147,19 +194,36 @@ Renderer& Renderer::rdil() {
     const RDProcessorPlugin* p = ctx->processorplugin;
     ct_assume(p);
 
-    rdil::ILExprList el;
-    RDInstruction instr{};
-    bool ok = ctx->worker->emulator.decode(this->current_address(), instr);
+    RDAddress address = this->current_address();
+    std::shared_ptr<const rdil::ILFunction> il;
+    std::span<const RDILExpr* const> exprs;
+
+    // Functions are lifted once and shared through the cache
+    if(const Function* f = ctx->program.find_function(address); f) {
+        il = state::context->rdilcache.get(*f);
+        exprs = il->at(address);
+    }
+
+    if(exprs.empty()) {
+        rdil::ILExprList& el = m_rdil;
+        el.reset();
+        el.currentaddress = address;
 
-    if(!ok || !p->lift || !p->lift(ctx->processor, api::to_c(&el), &instr))
-        el.clear();
+        RDInstruction instr{};
+        bool ok = ctx->worker->emulator.decode(address, instr);
 
-    if(el.empty()) el.append(el.expr_unknown());
+        if(!ok || !p->lift ||
+           !p->lift(ctx->processor, api::to_c(&el), &instr))
+            el.clear();
 
-    for(usize i = 0; i < el.size(); i++) {
+        if(el.empty()) el.append(el.expr_unknown());
+        exprs = {el.begin(), el.end()};
+    }
+
+    for(usize i = 0; i < exprs.size(); i++) {
         if(i) this->chunk("; ");
 
-        rdil::render(el.at(i), *this);
+        rdil::render(exprs[i], *this);
     }
 
     return *this;
@@ -177,7 +241,7 @@ Renderer& Renderer::addr(RDAddress address, int flags) {
                 this->chunk("+");
         }
 
-        this->chunk(ctx->get_name(address), THEME_ADDRESS);
+        this->chunk(ctx->get_name(address, this->arena), THEME_ADDRESS);
     }
     else
         this->constant(static_cast<u64>(address), 16, flags, THEME_ADDRESS);
@@ -186,51 +250,40 @@ Renderer& Renderer::addr(RDAddress address, int flags) {
 }
 
 Renderer& Renderer::int_i8(i8 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::int_i16(i16 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::int_i32(i32 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::int_i64(i64 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::int_u8(u8 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::int_u16(u16 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::int_u32(u32 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::int_u64(u64 v, int base, RDThemeKind fg) {
-    return this->chunk(render_int(v, base), fg);
+    return this->chunk(render_int(this->arena, v, base), fg);
 }
 
 Renderer& Renderer::new_row(const ListingItem& item) {
-    this->prevmnemonic = false;
-
-    if(!this->columns && !m_rows.empty()) {
-        this->autocolumns =
-            std::max(this->autocolumns, m_rows.back().cells.size());
-    }
-
-    m_rows.emplace_back(SurfaceRow{
-        .listingindex = m_listingidx,
-        .cells = {},
-    });
-
-    if(this->columns) m_rows.back().cells.reserve(this->columns);
+    SurfaceRow& row = this->push_row(m_listingidx);
+    if(this->columns) row.cells.reserve(this->columns);
 
     if(!this->has_flag(SURFACE_NOADDRESS)) {
         const RDSegment* s = this->current_segment();
@@ -238,7 +291,9 @@ Renderer& Renderer::new_row(const ListingItem& item) {
 
         const RDProcessorPlugin* p = state::context->processorplugin;
         ct_assume(p);
-        this->chunk(utils::to_hex(m_curraddress, s ? s->bits : -1)).ws(2);
+        int bits = s ? s->bits : -1;
+        this->chunk(format_int(this->arena, m_curraddress, 16, false, bits))
+            .ws(2);
 
         if(item.indent) this->ws(item.indent);
     }
@@ -258,13 +313,13 @@ Renderer& Renderer::constant(u64 c, int base, int flags, RDThemeKind fg) {
 
     if(sc < 0) {
         if(flags == RC_NOSIGN)
-            this->chunk(utils::to_string(std::abs(sc), base), fg);
+            this->chunk(format_int(this->arena, std::abs(sc), base), fg);
         else
-            this->chunk(utils::to_string(sc, base, true), fg);
+            this->chunk(format_int(this->arena, sc, base, true), fg);
     }
     else {
         if(flags == RC_NEEDSIGN) this->chunk("+", fg);
-        this->chunk(utils::to_string(c, base), fg);
+        this->chunk(format_int(this->arena, c, base), fg);
     }
 
     return *this;
@@ -282,7 +337,7 @@ Renderer& Renderer::mnem(const RDInstruction* instr, RDThemeKind fg) {
         if(res) mnemstr = res;
     }
 
-    if(mnemstr.empty()) mnemstr = utils::to_string(instr->id, 10);
+    if(mnemstr.empty()) mnemstr = format_int(this->arena, instr->id, 10);
     this->chunk(mnemstr, fg);
     this->prevmnemonic = true;
     return *this;
@@ -310,6 +365,22 @@ Renderer& Renderer::character(SurfaceRow& row, char ch, RDThemeKind fg,
     return *this;
 }
 
+Renderer& Renderer::ws(usize n) {
+    if(this->prevmnemonic) {
+        this->prevmnemonic = false;
+        n++;
+    }
+
+    SurfaceRow& row = m_rows.back();
+
+    for(usize i = 0; i < n; i++) {
+        if(this->columns && row.cells.size() >= this->columns) break;
+        this->character(row, ' ');
+    }
+
+    return *this;
+}
+
 Renderer& Renderer::chunk(std::string_view arg, RDThemeKind fg,
                           RDThemeKind bg) {
     if(this->prevmnemonic) {
@@ -369,30 +440,33 @@ void Renderer::check_current_segment(const ListingItem& item) {
 }
 
 std::string Renderer::word_at(const SurfaceRows& rows, int row, int col) {
-    if(row >= static_cast<int>(rows.size())) return {};
+    std::string word;
+    Renderer::word_at(rows, row, col, word);
+    return word;
+}
+
+void Renderer::word_at(const SurfaceRows& rows, int row, int col,
+                       std::string& word) {
+    word.clear();
+    if(row >= static_cast<int>(rows.size())) return;
 
     const SurfaceRow& sfrow = rows[row];
 
     if(col >= static_cast<int>(sfrow.cells.size()))
         col = sfrow.cells.size() - 1;
 
-    if(Renderer::is_char_skippable(sfrow.cells[col].ch)) return {};
+    if(Renderer::is_char_skippable(sfrow.cells[col].ch)) return;
 
-    std::string word;
+    int start = col;
 
-    for(int i = col; i-- > 0;) {
-        RDSurfaceCell cell = sfrow.cells[i];
-        if(Renderer::is_char_skippable(cell.ch)) break;
-        word.insert(0, &cell.ch, 1);
-    }
+    while(start > 0 && !Renderer::is_char_skippable(sfrow.cells[start - 1].ch))
+        start--;
 
-    for(int i = col; i < static_cast<int>(sfrow.cells.size()); i++) {
+    for(int i = start; i < static_cast<int>(sfrow.cells.size()); i++) {
         RDSurfaceCell cell = sfrow.cells[i];
         if(Renderer::is_char_skippable(cell.ch)) break;
-        word.append(&cell.ch, 1);
+        word.push_back(cell.ch);
     }
-
-    return word;
 }
 
 bool Renderer::is_char_skippable(char ch) {
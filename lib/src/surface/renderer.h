@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../listing.h"
+#include "../rdil/expressionlist.h"
+#include "framearena.h"
 #include <redasm/renderer.h>
 #include <redasm/surface.h>
 #include <redasm/theme.h>
@@ -28,6 +30,9 @@ struct Renderer {
     void highlight_cursor(int row, int col);
     void fill_columns();
     void set_current_item(LIndex lidx, const ListingItem& item);
+    void append_row(const SurfaceRow& row);
+    [[nodiscard]] usize rows_count() const { return m_rows.size(); }
+    [[nodiscard]] const SurfaceRow& row(usize idx) const { return m_rows[idx]; }
 
     Renderer& new_row(const ListingItem& item);
     Renderer& constant(u64 c, int base = 0, int flags = 0,
@@ -45,10 +50,7 @@ struct Renderer {
 
     [[nodiscard]] bool has_flag(usize f) const { return this->flags & f; }
 
-    void clear() {
-        m_rows.clear();
-        this->autocolumns = 0;
-    }
+    void clear();
 
     Renderer& arr_index(usize idx) {
         return this->chunk("[").constant(idx).chunk("]");
@@ -96,9 +98,11 @@ struct Renderer {
         return this->chunk(q, fg, bg).chunk(arg, fg, bg).chunk(q, fg, bg);
     }
 
-    Renderer& ws(usize n = 1) { return this->chunk(std::string(n, ' ')); }
+    Renderer& ws(usize n = 1);
 
     static std::string word_at(const SurfaceRows& rows, int row, int col);
+    static void word_at(const SurfaceRows& rows, int row, int col,
+                        std::string& word);
     static bool is_char_skippable(char ch);
 
 public: // High level interface
@@ -115,19 +119,24 @@ public: // High level interface
     Renderer& int_u64(u64 v, int base, RDThemeKind fg = THEME_CONSTANT);
 
 public:
+    FrameArena arena; // Reset on clear()
     bool prevmnemonic{false}; // Autoinsert whitespace on next chunk
     usize columns{0}, autocolumns{0};
     usize flags;
 
 private:
     const RDSegment* current_segment() const;
+    SurfaceRow& push_row(LIndex lidx);
     void check_current_segment(const ListingItem& item);
 
 private:
     SurfaceRows m_rows;
+    std::vector<std::vector<RDSurfaceCell>> m_cellpool; // Reused row storage
     RDAddress m_curraddress{};
     LIndex m_listingidx{};
     isize m_segmidx{0};
+    rdil::ILExprList m_rdil; // Reused by every RDIL row
+    std::string m_word;      // highlight_words() scratch buffer
 };
 
 } // namespace redasm
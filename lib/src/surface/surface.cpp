@@ -7,6 +7,7 @@
 #include "../state.h"
 #include "../utils/utils.h"
 #include <algorithm>
+#include <tuple>
 #include <redasm/listing.h>
 
 namespace redasm {
@@ -113,7 +114,7 @@ tl::optional<LIndex> Surface::current_listing_index() const {
 
 tl::optional<RDAddress> Surface::current_address() const {
     return this->current_listing_index().map(
-        [](LIndex index) { return state::context->listing[index].address; });
+        [](LIndex index) { return state::context->listing.address_at(index); });
 }
 
 tl::optional<usize> Surface::address_under_pos(RDSurfacePosition pos) const {
@@ -148,23 +149,22 @@ const Function* Surface::current_function() const {
 
 void Surface::render_function(const Function& f) {
     m_renderer->clear();
+    m_prefetch.clear();
     state::context->worker->emulator.reset();
     const Listing& listing = state::context->listing;
 
     for(const Function::BasicBlock& bb : f.blocks) {
-        auto startit = listing.lower_bound(bb.start);
+        LIndex startidx = listing.lower_bound(bb.start);
 
-        if(startit == listing.end()) {
+        if(startidx >= listing.size()) {
             state::log("ERROR: Cannot find basic-block(s)");
             m_renderer->clear();
             break;
         }
 
-        auto endit = listing.upper_bound(bb.end, startit);
-        ct_assume(startit < endit);
-        LIndex startidx = std::distance(listing.begin(), startit);
-        LIndex n = std::distance(startit, endit);
-        this->render_range(startidx, n);
+        LIndex endidx = listing.upper_bound(bb.end, startidx);
+        ct_assume(startidx < endidx);
+        this->render_range(startidx, endidx - startidx);
     }
 
     this->render_finalize();
@@ -172,11 +172,20 @@ void Surface::render_function(const Function& f) {
 
 void Surface::render(usize n) {
     m_renderer->clear();
+    m_prefetch.clear();
     state::context->worker->emulator.reset();
     this->start.map([&](LIndex s) { this->render_range(s, n); });
     this->render_finalize();
 }
 
+// Renders [start, start + n) without cursor, selection and row cache
+void Surface::render_rows(LIndex start, usize n) {
+    m_renderer->clear();
+    m_prefetch.clear();
+    this->render_range(start, n, false);
+    m_renderer->swap(this->rows);
+}
+
 bool Surface::go_back() {
     if(m_histback.empty()) return false;
 
@@ -234,11 +243,11 @@ void Surface::seek(LIndex index) { // Seek doesn't update back/forward stack
 
 bool Surface::jump_to(RDAddress address) {
     Context* ctx = state::context;
-    auto it = ctx->listing.lower_bound(address);
+    auto lidx = ctx->listing.find_row(address);
 
-    if(it != ctx->listing.end()) {
+    if(lidx) {
         this->update_history(m_histback);
-        this->start = std::distance(ctx->listing.cbegin(), it);
+        this->start = *lidx;
         return true;
     }
 
@@ -255,51 +264,32 @@ bool Surface::jump_to_ep() {
 }
 
 const std::vector<RDSurfacePath>& Surface::get_path() const {
-    const Context* ctx = state::context;
+    Context* ctx = state::context;
     const Listing& lst = ctx->listing;
 
     m_path.clear();
-    m_done.clear();
-
-    for(usize i = 0; this->start && i < this->rows.size(); i++) {
-        usize lidx = *this->start + i;
-        if(lidx >= lst.size()) break;
+    if(!this->start || this->rows.empty()) return m_path;
 
-        const ListingItem& item = lst[lidx];
-        if(item.type != LISTINGITEM_INSTRUCTION) continue;
+    RDAddress startaddr = lst.address_at(this->rows.front().listingindex);
+    RDAddress endaddr = lst.address_at(this->rows.back().listingindex);
 
-        const RDSegment* seg = ctx->program.find_segment(item.address);
-        ct_assume(seg);
+    for(const JumpIndex::Jump* j : ctx->jumpindex.query(startaddr, endaddr)) {
+        this->insert_path(j->conditional, this->calculate_index(j->fromaddr),
+                          this->calculate_index(j->toaddr));
+    }
 
-        if(memory::has_flag(seg, item.address, BF_JUMPDST)) {
-            for(const auto& [toaddr, type] :
-                ctx->get_refs_to_type(item.address, CR_JUMP)) {
-                seg = ctx->program.find_segment(toaddr);
+    // Jumps crossing the whole window collapse to the same path
+    std::ranges::sort(m_path, [](const RDSurfacePath& a,
+                                 const RDSurfacePath& b) {
+        return std::tie(a.fromrow, a.torow) < std::tie(b.fromrow, b.torow);
+    });
 
-                if(seg && (seg->perm & SP_X)) {
-                    if(auto mb = memory::get_mbyte(seg, toaddr); mb) {
-                        this->insert_path(*mb, this->calculate_index(toaddr),
-                                          i);
-                    }
-                }
-            }
-        }
-        else if(memory::has_flag(seg, item.address, BF_JUMP)) {
-            for(const auto& [fromaddr, type] :
-                ctx->get_refs_from_type(item.address, CR_JUMP)) {
-                seg = ctx->program.find_segment(fromaddr);
-
-                if(seg && (seg->perm & SP_X) &&
-                   memory::has_flag(seg, fromaddr, BF_CODE)) {
-                    if(auto mb = memory::get_mbyte(seg, fromaddr); mb) {
-                        this->insert_path(*mb, i,
-                                          this->calculate_index(fromaddr));
-                    }
-                }
-            }
-        }
-    }
+    auto [first, last] = std::ranges::unique(
+        m_path, [](const RDSurfacePath& a, const RDSurfacePath& b) {
+            return a.fromrow == b.fromrow && a.torow == b.torow;
+        });
 
+    m_path.erase(first, last);
     return m_path;
 }
 
@@ -441,35 +431,36 @@ bool Surface::has_selection() const {
 
 bool Surface::has_rdil() const { return m_renderer->has_flag(SURFACE_RDIL); }
 
-const ListingItem& Surface::get_listing_item(const SurfaceRow& sfrow) const {
+ListingItem Surface::get_listing_item(const SurfaceRow& sfrow) const {
     ct_assume(sfrow.listingindex < state::context->listing.size());
     return state::context->listing[sfrow.listingindex];
 }
 
 int Surface::calculate_index(RDAddress address) const {
-    if(!this->rows.empty()) {
-        const ListingItem& first = this->get_listing_item(this->rows.front());
-        if(address < first.address) return -1;
+    if(this->rows.empty()) return -1;
 
-        const ListingItem& last = this->get_listing_item(this->rows.back());
-        if(address > last.address) return this->rows.size() + 1;
-    }
-
-    int residx = -1;
+    const Listing& lst = state::context->listing;
+    if(address < lst.address_at(this->rows.front().listingindex)) return -1;
 
-    for(usize i = this->rows.size(); i-- > 0;) {
-        const ListingItem& item = this->get_listing_item(this->rows[i]);
+    if(address > lst.address_at(this->rows.back().listingindex))
+        return this->rows.size() + 1;
 
-        if(item.address == address) {
-            residx = i;
+    LIndex lidx = lst.lower_bound(address);
+    if(lidx >= lst.size()) return -1;
 
-            if(item.type == LISTINGITEM_INSTRUCTION) break;
+    // Prefer the instruction row
+    for(LIndex i = lidx; i < lst.size() && lst.address_at(i) == address; i++) {
+        if(lst.type_at(i) == LISTINGITEM_INSTRUCTION) {
+            lidx = i;
+            break;
         }
-
-        if(item.address < address) break;
     }
 
-    return residx;
+    auto it = std::ranges::lower_bound(this->rows, lidx, {},
+                                       &SurfaceRow::listingindex);
+
+    if(it == this->rows.end() || it->listingindex != lidx) return -1;
+    return std::distance(this->rows.begin(), it);
 }
 
 void Surface::update_history(History& history) const {
@@ -487,13 +478,11 @@ void Surface::update_history(History& history) const {
         history.emplace_front(hitem);
 }
 
-void Surface::insert_path(RDMByte b, int fromrow, int torow) const {
+void Surface::insert_path(bool conditional, int fromrow, int torow) const {
     if(fromrow == torow) return;
 
-    if(auto it = m_done.emplace(fromrow, torow); !it.second) return;
-
     if(fromrow > torow) { // Loop
-        if(mbyte::has_flag(b, BF_FLOW)) {
+        if(conditional) {
             m_path.push_back(
                 RDSurfacePath{fromrow, torow, THEME_GRAPHEDGELOOPCOND});
         }
@@ -503,7 +492,7 @@ void Surface::insert_path(RDMByte b, int fromrow, int torow) const {
         }
     }
     else {
-        if(mbyte::has_flag(b, BF_FLOW))
+        if(conditional)
             m_path.push_back(RDSurfacePath{fromrow, torow, THEME_SUCCESS});
         else
             m_path.push_back(RDSurfacePath{fromrow, torow, THEME_GRAPHEDGE});
@@ -523,51 +512,101 @@ void Surface::render_finalize() {
     m_renderer->swap(this->rows);
 }
 
-void Surface::render_range(LIndex start, usize n) {
+void Surface::render_range(LIndex start, usize n, bool cache) {
     const Listing& listing = state::context->listing;
 
-    auto it = std::next(listing.begin(), start);
-    if(it == listing.end()) return;
+    if(start >= listing.size()) return;
+    if(cache) this->check_row_cache();
+
+    for(usize i = 0; start + i < listing.size() && i < n; i++) {
+        if(!cache || !m_rowcache.contains(start + i)) {
+            this->prefetch_range(start, n);
+            break;
+        }
+    }
+
+    for(usize i = 0; start + i < listing.size() && i < n; i++) {
+        if(auto it = m_rowcache.find(start + i);
+           cache && it != m_rowcache.end()) {
+            for(const SurfaceRow& row : it->second)
+                m_renderer->append_row(row);
+            continue;
+        }
 
-    for(usize i = 0; it != listing.end() && i < n; it++, i++) {
-        m_renderer->set_current_item(start + i, *it);
+        usize firstrow = m_renderer->rows_count();
+        const ListingItem item = listing[start + i];
+        m_renderer->set_current_item(start + i, item);
 
-        switch(it->type) {
-            case LISTINGITEM_EMPTY: m_renderer->new_row(*it); break;
-            case LISTINGITEM_HEX_DUMP: this->render_hexdump(*it); break;
-            case LISTINGITEM_FILL: this->render_fill(*it); break;
-            case LISTINGITEM_SEGMENT: this->render_segment(*it); break;
-            case LISTINGITEM_FUNCTION: this->render_function(*it); break;
-            case LISTINGITEM_LABEL: this->render_label(*it); break;
+        switch(item.type) {
+            case LISTINGITEM_EMPTY: m_renderer->new_row(item); break;
+            case LISTINGITEM_HEX_DUMP: this->render_hexdump(item); break;
+            case LISTINGITEM_FILL: this->render_fill(item); break;
+            case LISTINGITEM_SEGMENT: this->render_segment(item); break;
+            case LISTINGITEM_FUNCTION: this->render_function(item); break;
+            case LISTINGITEM_LABEL: this->render_label(item); break;
 
             case LISTINGITEM_INSTRUCTION: {
-                m_renderer->new_row(*it);
+                m_renderer->new_row(item);
 
                 if(this->has_rdil())
                     m_renderer->rdil();
                 else
                     m_renderer->instr();
 
-                this->render_refs(*it);
-                this->render_comment(*it);
+                this->render_refs(item);
+                this->render_comment(item);
                 break;
             }
 
             case LISTINGITEM_TYPE:
-                if(it->dtype->n > 0)
-                    this->render_array(*it);
+                if(item.dtype->n > 0)
+                    this->render_array(item);
                 else
-                    this->render_type(*it);
+                    this->render_type(item);
 
-                this->render_refs(*it);
-                this->render_comment(*it);
+                this->render_refs(item);
+                this->render_comment(item);
                 break;
 
             default: break;
         }
+
+        if(cache) this->cache_rows(start + i, firstrow);
+    }
+}
+
+void Surface::check_row_cache() {
+    RowCacheKey key{
+        .flags = m_renderer->flags,
+        .columns = m_renderer->columns,
+        .revision = state::context->revision(),
+    };
+
+    if(key != m_rowcachekey || m_rowcache.size() >= ROW_CACHE_SIZE) {
+        m_rowcache.clear();
+        m_rowcachekey = key;
     }
 }
 
+void Surface::prefetch_range(LIndex start, usize n) const {
+    const Listing& listing = state::context->listing;
+    if(!n || start >= listing.size()) return;
+
+    LIndex last = std::min(start + n, listing.size()) - 1;
+    RDAddress startaddr = listing.address_at(start);
+    RDAddress endaddr = listing.address_at(last);
+
+    if(!m_prefetch.contains(startaddr, endaddr))
+        m_prefetch.fetch(startaddr, endaddr);
+}
+
+void Surface::cache_rows(LIndex lidx, usize firstrow) {
+    SurfaceRows& rows = m_rowcache[lidx];
+
+    for(usize i = firstrow; i < m_renderer->rows_count(); i++)
+        rows.push_back(m_renderer->row(i));
+}
+
 void Surface::render_hexdump(const ListingItem& item) {
     static constexpr usize HEX_WIDTH = 16;
 
@@ -589,7 +628,7 @@ void Surface::render_hexdump(const ListingItem& item) {
     }
 
     if(c < HEX_WIDTH * 3)
-        m_renderer->chunk(std::string((HEX_WIDTH * 3) - c, ' '));
+        m_renderer->ws((HEX_WIDTH * 3) - c);
 
     c = 0;
 
@@ -599,14 +638,14 @@ void Surface::render_hexdump(const ListingItem& item) {
 
         if(mb && mbyte::has_byte(*mb)) {
             u8 b = mbyte::get_byte(*mb);
-            std::string s{std::isprint(b) ? static_cast<char>(b) : '.'};
-            m_renderer->chunk(s);
+            char ch = std::isprint(b) ? static_cast<char>(b) : '.';
+            m_renderer->chunk(std::string_view{&ch, 1});
         }
         else
             m_renderer->nop("?");
     }
 
-    if(c < HEX_WIDTH) m_renderer->chunk(std::string(HEX_WIDTH - c, ' '));
+    if(c < HEX_WIDTH) m_renderer->ws(HEX_WIDTH - c);
 }
 
 void Surface::render_fill(const ListingItem& item) {
@@ -629,8 +668,10 @@ void Surface::render_fill(const ListingItem& item) {
 }
 
 void Surface::render_label(const ListingItem& item) {
-    std::string name = state::context->get_name(item.address);
-    m_renderer->new_row(item).chunk(name + ":", THEME_ADDRESS);
+    std::string_view name = m_prefetch.get_name(item.address);
+    m_renderer->new_row(item)
+        .chunk(name, THEME_ADDRESS)
+        .chunk(":", THEME_ADDRESS);
 }
 
 void Surface::render_segment(const ListingItem& item) {
@@ -661,7 +702,7 @@ void Surface::render_function(const ListingItem& item) {
     const RDProcessorPlugin* p = ctx->processorplugin;
     ct_assume(p);
 
-    const Function* f = state::context->program.find_function(item.address);
+    const Function* f = state::context->program.get_function(item.address);
     ct_assume(f);
 
     if(p->render_function)
@@ -683,7 +724,7 @@ void Surface::render_type(const ListingItem& item) {
     const RDSegment* seg = ctx->program.find_segment(item.address);
     ct_assume(seg);
 
-    std::string fname;
+    std::string_view fname;
 
     if(item.field_index) {
         ct_assume(type->def->kind == TK_STRUCT);
@@ -694,7 +735,7 @@ void Surface::render_type(const ListingItem& item) {
         type = item.dtype;
     }
     else
-        fname = ctx->get_name(item.address);
+        fname = m_prefetch.get_name(item.address);
 
     ct_assume(type);
     std::string t = ctx->types.to_string(*type);
@@ -705,7 +746,7 @@ void Surface::render_type(const ListingItem& item) {
 
     if(type->def->kind == TK_STRUCT) {
         if(!item.array_index) {
-            std::string label = ctx->get_name(item.address);
+            std::string_view label = m_prefetch.get_name(item.address);
             m_renderer->function("struct")
                 .ws()
                 .type(type->def->name)
@@ -805,7 +846,7 @@ void Surface::render_comment(const ListingItem& item) {
     int i = 0;
 
     utils::split_each(
-        state::context->get_comment(item.address), '\n',
+        m_prefetch.get_comment(item.address), '\n',
         [&](std::string_view x) {
             m_renderer->comment(i++ > 0 ? " | " : "# ").comment(x);
             return true;
@@ -818,7 +859,7 @@ void Surface::render_refs(const ListingItem& item) {
     const Context* ctx = state::context;
     bool paddingdone = false;
 
-    for(const auto& [fromaddr, _] : ctx->get_refs_from(item.address)) {
+    for(const auto& [fromaddr, _] : m_prefetch.get_refs_from(item.address)) {
         const RDSegment* seg = ctx->program.find_segment(fromaddr);
         if(!seg || !memory::has_flag(seg, fromaddr, BF_TYPE)) continue;
 
@@ -892,7 +933,8 @@ void Surface::render_array(const ListingItem& item) {
 
     const Context* ctx = state::context;
     auto type = item.dtype;
-    std::string chars;
+    std::string& chars = m_chars;
+    chars.clear();
 
     ct_assume(type->def);
 
@@ -914,7 +956,8 @@ void Surface::render_array(const ListingItem& item) {
             if(std::isprint(b->ch_v))
                 chars += b->ch_v;
             else
-                chars += fmt::format("\\x{}", static_cast<int>(b->ch_v));
+                fmt::format_to(std::back_inserter(chars), "\\x{}",
+                               static_cast<int>(b->ch_v));
 
             rdvalue_destroy(&b.value());
         }
@@ -943,7 +986,7 @@ void Surface::render_array(const ListingItem& item) {
         m_renderer->new_row(item);
         if(type->def->kind == TK_STRUCT) m_renderer->function("struct ");
 
-        std::string name = ctx->get_name(item.address);
+        std::string_view name = m_prefetch.get_name(item.address);
         m_renderer->type(ctx->types.to_string(*type)).ws().chunk(name);
 
         if(item.array_index) m_renderer->arr_index(*item.array_index);
@@ -2,13 +2,14 @@
 
 #include "../disasm/function.h"
 #include "../listing.h"
+#include "prefetch.h"
 #include "renderer.h"
 #include <deque>
 #include <memory>
 #include <redasm/renderer.h>
-#include <set>
 #include <string>
 #include <tl/optional.hpp>
+#include <unordered_map>
 
 namespace redasm {
 
@@ -30,6 +31,14 @@ private:
 
     using History = std::deque<HistoryItem>;
 
+    // Rendered rows are valid until one of these changes
+    struct RowCacheKey {
+        usize flags, columns, revision;
+        bool operator==(const RowCacheKey&) const = default;
+    };
+
+    static constexpr usize ROW_CACHE_SIZE = 0x4000;
+
 public:
     explicit Surface(usize flags = SURFACE_DEFAULT);
     Renderer* renderer() const { return m_renderer.get(); }
@@ -55,6 +64,7 @@ public:
     void clear_history();
     void render_function(const Function& f);
     void render(usize n);
+    void render_rows(LIndex start, usize n);
     void set_rdil(bool v);
     void set_columns(usize cols);
     void set_position(int row, int col);
@@ -68,12 +78,15 @@ public:
     bool jump_to_ep();
 
 private:
-    const ListingItem& get_listing_item(const SurfaceRow& sfrow) const;
+    ListingItem get_listing_item(const SurfaceRow& sfrow) const;
     int calculate_index(RDAddress address) const;
     void update_history(History& history) const;
-    void insert_path(RDMByte b, int fromrow, int torow) const;
+    void insert_path(bool conditional, int fromrow, int torow) const;
     void render_finalize();
-    void render_range(LIndex start, usize n);
+    void render_range(LIndex start, usize n, bool cache = true);
+    void check_row_cache();
+    void prefetch_range(LIndex start, usize n) const;
+    void cache_rows(LIndex lidx, usize firstrow);
     void render_hexdump(const ListingItem& item);
     void render_fill(const ListingItem& item);
     void render_label(const ListingItem& item);
@@ -104,9 +117,12 @@ public:
 private:
     std::unique_ptr<Renderer> m_renderer;
     History m_histback, m_histforward;
-    mutable std::set<std::pair<int, int>> m_done;
     mutable std::vector<RDSurfacePath> m_path;
     mutable std::string m_strcache;
+    mutable Prefetch m_prefetch;
+    std::string m_chars; // render_array() scratch buffer
+    std::unordered_map<LIndex, SurfaceRows> m_rowcache;
+    RowCacheKey m_rowcachekey{};
     bool m_lockhistory{false};
     int m_row{0}, m_col{0};
     int m_selrow{0}, m_selcol{0};
@@ -0,0 +1,305 @@
+#include "symbolindex.h"
+#include "context.h"
+#include "memory/memory.h"
+#include "state.h"
+#include "symboltable.h"
+#include "utils/utils.h"
+#include <algorithm>
+#include <cctype>
+
+namespace redasm {
+
+namespace {
+
+constexpr usize TRIGRAM_SIZE = 3;
+
+// clang-format off
+enum SearchRank : u32 {
+    RANK_EXACT = 0,
+    RANK_PREFIX,
+    RANK_WORD,
+    RANK_SUBSTRING,
+};
+// clang-format on
+
+u32 make_trigram(std::string_view s, usize idx) {
+    return static_cast<u8>(s[idx]) | (static_cast<u8>(s[idx + 1]) << 8) |
+           (static_cast<u8>(s[idx + 2]) << 16);
+}
+
+tl::optional<u32> get_rank(std::string_view key, std::string_view q) {
+    usize pos = key.find(q);
+    if(pos == std::string_view::npos) return tl::nullopt;
+    if(pos == 0) return key.size() == q.size() ? RANK_EXACT : RANK_PREFIX;
+
+    // Prefer matches at the start of a word (eg: "str" in "sub_strlen")
+    for(; pos != std::string_view::npos; pos = key.find(q, pos + 1)) {
+        if(!std::isalnum(static_cast<unsigned char>(key[pos - 1])))
+            return RANK_WORD;
+    }
+
+    return RANK_SUBSTRING;
+}
+
+} // namespace
+
+void listingindex_tosymbol(LIndex lidx, RDSymbol* symbol, std::string& value) {
+    ct_assume(symbol);
+    const Context* ctx = state::context;
+    ct_assume(ctx);
+    const Listing& listing = ctx->listing;
+    const Listing::SymbolRow* item = listing.symbol_row(lidx);
+    ct_assume(item);
+
+    symbol->address = item->address;
+
+    switch(item->type) {
+        case LISTINGITEM_SEGMENT: {
+            const RDSegment* seg = ctx->program.find_segment(item->address);
+            ct_assume(seg);
+            symbol->type = SYMBOL_SEGMENT;
+            symbol->theme = THEME_SEGMENT;
+            symbol->value = seg->name;
+            break;
+        }
+
+        case LISTINGITEM_LABEL:
+        case LISTINGITEM_FUNCTION: {
+            value = ctx->get_name(item->address);
+            symbol->type = SYMBOL_FUNCTION;
+            symbol->theme = THEME_FUNCTION;
+            symbol->value = value.c_str();
+            break;
+        }
+
+        case LISTINGITEM_TYPE: {
+            const RDSegment* seg = ctx->program.find_segment(item->address);
+            ct_assume(seg);
+            tl::optional<std::string> s;
+            ct_assume(item->dtype);
+
+            if(item->dtype->def->kind == TK_PRIMITIVE) {
+                switch(item->dtype->def->t_primitive) {
+                    case T_STR: {
+                        s = memory::get_str(seg, item->address);
+                        ct_assume(s);
+                        s = s->substr(item->string_index, item->length);
+                        break;
+                    }
+
+                    case T_WSTR: {
+                        s = memory::get_wstr(seg, item->address);
+                        ct_assume(s);
+                        s = s->substr(item->string_index, item->length);
+                        break;
+                    }
+
+                    case T_CHAR: {
+                        usize len =
+                            memory::get_length(seg, item->address);
+                        ct_assume(len > 0);
+                        s = memory::get_str(seg, item->address, len);
+                        break;
+                    }
+
+                    case T_WCHAR: {
+                        usize len =
+                            memory::get_length(seg, item->address);
+                        ct_assume(len > 0);
+                        s = memory::get_wstr(seg, item->address, len);
+                        break;
+                    }
+
+                    default: break;
+                }
+            }
+
+            if(!s) {
+                value = ctx->get_name(item->address);
+
+                symbol->type = SYMBOL_TYPE;
+                symbol->theme = THEME_DEFAULT;
+                symbol->value = value.c_str();
+            }
+            else {
+                value = "\"" + *s + "\"";
+
+                symbol->type = SYMBOL_STRING;
+                symbol->theme = THEME_STRING;
+                symbol->value = value.c_str();
+            }
+
+            break;
+        }
+
+        default: ct_unreachable; break;
+    }
+}
+
+const SymbolIndex::Results& SymbolIndex::search(std::string_view query,
+                                                usize flags) {
+    if(m_dirty) this->build();
+
+    std::string q = utils::to_lower(std::string{query});
+    if(q == m_lastquery && flags == m_lastflags) return m_results;
+
+    m_results = this->find(q, flags);
+    m_lastquery = std::move(q);
+    m_lastflags = flags;
+    return m_results;
+}
+
+SymbolIndex::Results SymbolIndex::find(std::string_view query,
+                                       usize flags) const {
+    if(!(flags & SEARCH_ALL)) flags |= SEARCH_ALL;
+
+    std::string q = utils::to_lower(std::string{query});
+    Results res;
+    if(q.empty()) return res;
+
+    std::vector<u32> candidates;
+
+    if(flags & SEARCH_PREFIX)
+        this->candidates_prefix(q, candidates);
+    else if(q.size() >= TRIGRAM_SIZE)
+        this->candidates_trigram(q, candidates);
+    else {
+        candidates.resize(m_entries.size());
+        for(usize i = 0; i < candidates.size(); i++)
+            candidates[i] = i;
+    }
+
+    for(u32 id : candidates) {
+        const Entry& e = m_entries[id];
+        if(!(e.source & flags)) continue;
+
+        if(auto rank = get_rank(e.key, q); rank) {
+            if((flags & SEARCH_PREFIX) && *rank > RANK_PREFIX) continue;
+            res.push_back({.entry = id, .rank = *rank});
+        }
+    }
+
+    std::ranges::sort(res, [&](const Result& a, const Result& b) {
+        const Entry& ea = m_entries[a.entry];
+        const Entry& eb = m_entries[b.entry];
+        if(a.rank != b.rank) return a.rank < b.rank;
+        if(ea.key.size() != eb.key.size()) return ea.key.size() < eb.key.size();
+        return ea.address < eb.address;
+    });
+
+    return res;
+}
+
+void SymbolIndex::build(const SymbolTable& t) {
+    this->clear();
+    this->add_table(t);
+    this->finalize();
+}
+
+void SymbolIndex::build() {
+    Context* ctx = state::context;
+    ct_assume(ctx);
+
+    this->clear();
+
+    // Names and strings come from the shared symbol table snapshot
+    this->add_table(*ctx->get_symbol_table(SYMBOLTABLE_SYMBOLS));
+
+    for(auto& [address, comment] : ctx->get_comments()) {
+        this->add_entry({
+            .address = address,
+            .type = SYMBOL_COMMENT,
+            .theme = THEME_COMMENT,
+            .source = SEARCH_COMMENTS,
+            .value = std::move(comment),
+        });
+    }
+
+    this->finalize();
+    spdlog::info("Symbol index: {} entries, {} trigrams", m_entries.size(),
+                 m_trigrams.size());
+}
+
+void SymbolIndex::clear() {
+    m_entries.clear();
+    m_sorted.clear();
+    m_trigrams.clear();
+    m_lastquery.clear();
+    m_lastflags = 0;
+    m_results.clear();
+}
+
+void SymbolIndex::add_table(const SymbolTable& t) {
+    m_entries.reserve(m_entries.size() + t.size());
+
+    for(usize i = 0; i < t.size(); i++) {
+        const SymbolTable::Entry& e = t.at(i);
+
+        this->add_entry({
+            .address = e.address,
+            .type = e.type,
+            .theme = e.theme,
+            .source = e.type == SYMBOL_STRING ? SEARCH_STRINGS : SEARCH_NAMES,
+            .value = e.value,
+            .key = std::string{e.key},
+        });
+    }
+}
+
+void SymbolIndex::finalize() {
+    m_sorted.resize(m_entries.size());
+    for(usize i = 0; i < m_sorted.size(); i++)
+        m_sorted[i] = i;
+
+    std::ranges::sort(m_sorted, [&](u32 a, u32 b) {
+        return m_entries[a].key < m_entries[b].key;
+    });
+
+    m_dirty = false;
+}
+
+void SymbolIndex::add_entry(Entry e) {
+    auto id = static_cast<u32>(m_entries.size());
+    if(e.key.empty()) e.key = utils::to_lower(e.value);
+
+    for(usize i = 0; i + TRIGRAM_SIZE <= e.key.size(); i++) {
+        std::vector<u32>& p = m_trigrams[make_trigram(e.key, i)];
+        if(p.empty() || p.back() != id) p.push_back(id); // Keep it sorted
+    }
+
+    m_entries.push_back(std::move(e));
+}
+
+void SymbolIndex::candidates_prefix(std::string_view q,
+                                    std::vector<u32>& res) const {
+    auto it = std::ranges::lower_bound(
+        m_sorted, q, std::less<>{},
+        [&](u32 id) { return std::string_view{m_entries[id].key}; });
+
+    for(; it != m_sorted.end() && m_entries[*it].key.starts_with(q); it++)
+        res.push_back(*it);
+}
+
+void SymbolIndex::candidates_trigram(std::string_view q,
+                                     std::vector<u32>& res) const {
+    std::vector<const std::vector<u32>*> postings;
+
+    for(usize i = 0; i + TRIGRAM_SIZE <= q.size(); i++) {
+        auto it = m_trigrams.find(make_trigram(q, i));
+        if(it == m_trigrams.end()) return; // No matches
+        postings.push_back(&it->second);
+    }
+
+    // Intersect starting from the rarest trigram
+    std::ranges::sort(postings, {}, [](const auto* p) { return p->size(); });
+    res = *postings.front();
+
+    for(usize i = 1; i < postings.size() && !res.empty(); i++) {
+        std::vector<u32> tmp;
+        std::ranges::set_intersection(res, *postings[i],
+                                      std::back_inserter(tmp));
+        res = std::move(tmp);
+    }
+}
+
+} // namespace redasm
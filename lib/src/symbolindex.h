@@ -0,0 +1,67 @@
+#pragma once
+
+#include <redasm/listing.h>
+#include <redasm/types.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace redasm {
+
+class SymbolTable;
+
+void listingindex_tosymbol(LIndex lidx, RDSymbol* symbol, std::string& value);
+
+class SymbolIndex {
+public:
+    struct Entry {
+        RDAddress address;
+        usize type;
+        RDThemeKind theme;
+        usize source; // SEARCH_NAMES, SEARCH_COMMENTS or SEARCH_STRINGS
+        std::string value;
+        std::string key; // Lowercase 'value'
+    };
+
+    struct Result {
+        u32 entry;
+        u32 rank;
+    };
+
+    using Results = std::vector<Result>;
+
+public:
+    void invalidate() { m_dirty = true; }
+
+    // Context index (names, strings and comments), the last query is cached
+    const Results& search(std::string_view query, usize flags);
+
+    // Indexes 't' only, entry ids match the table's indices
+    void build(const SymbolTable& t);
+
+    // Doesn't touch the index: safe to call from multiple threads
+    [[nodiscard]] Results find(std::string_view query, usize flags) const;
+
+    const Entry& entry(const Result& r) const { return m_entries[r.entry]; }
+
+private:
+    void build();
+    void clear();
+    void add_table(const SymbolTable& t);
+    void add_entry(Entry e);
+    void finalize();
+    void candidates_prefix(std::string_view q, std::vector<u32>& res) const;
+    void candidates_trigram(std::string_view q, std::vector<u32>& res) const;
+
+private:
+    std::vector<Entry> m_entries;
+    std::vector<u32> m_sorted; // Entries sorted by key (prefix search)
+    std::unordered_map<u32, std::vector<u32>> m_trigrams;
+    std::string m_lastquery;
+    usize m_lastflags{0};
+    Results m_results;
+    bool m_dirty{true};
+};
+
+} // namespace redasm
@@ -0,0 +1,145 @@
+#include "symboltable.h"
+#include "context.h"
+#include "state.h"
+#include "utils/utils.h"
+#include <algorithm>
+#include <numeric>
+
+namespace redasm {
+
+namespace {
+
+const Listing::LIndexList& get_indices(const Listing& listing, usize kind) {
+    switch(kind) {
+        case SYMBOLTABLE_IMPORTS: return listing.imports();
+        case SYMBOLTABLE_EXPORTS: return listing.exports();
+        default: break;
+    }
+
+    return listing.symbols();
+}
+
+} // namespace
+
+SymbolTable::SymbolTable(usize kind, usize generation)
+    : m_kind{kind}, m_generation{generation} {
+    const Context* ctx = state::context;
+    ct_assume(ctx);
+
+    const Listing::LIndexList& indices = get_indices(ctx->listing, kind);
+    m_entries.reserve(indices.size());
+
+    std::string value;
+
+    for(LIndex lidx : indices) {
+        RDSymbol symbol;
+        listingindex_tosymbol(lidx, &symbol, value);
+
+        std::string_view v = this->intern(symbol.value);
+
+        m_entries.push_back({
+            .address = symbol.address,
+            .type = symbol.type,
+            .theme = symbol.theme,
+            .value = v.data(),
+            .key = this->intern(utils::to_lower(std::string{v})),
+        });
+    }
+}
+
+const SymbolIndex& SymbolTable::index() const {
+    std::call_once(m_indexonce, [this]() { m_index.build(*this); });
+    return m_index;
+}
+
+std::string_view SymbolTable::intern(std::string s) {
+    return *m_strings.insert(std::move(s)).first;
+}
+
+SymbolView::SymbolView(std::shared_ptr<const SymbolTable> t)
+    : m_table{std::move(t)} {
+    ct_assume(m_table);
+    m_order.resize(m_table->size());
+    std::iota(m_order.begin(), m_order.end(), 0);
+    m_filter.assign((m_table->size() + 63) / 64, ~u64{0});
+    m_view = m_order;
+}
+
+bool SymbolView::is_valid() const {
+    const Context* ctx = state::context;
+    return ctx && ctx->symbol_generation() == m_table->generation();
+}
+
+const SymbolTable::Entry* SymbolView::at(usize idx) const {
+    if(idx >= m_view.size()) return nullptr;
+    return &m_table->at(m_view[idx]);
+}
+
+void SymbolView::sort(usize column, bool descending) {
+    const SymbolTable& t = *m_table;
+
+    auto cmp = [&](u32 a, u32 b) {
+        const SymbolTable::Entry& ea = t.at(a);
+        const SymbolTable::Entry& eb = t.at(b);
+
+        switch(column) {
+            case SYMBOLCOLUMN_TYPE:
+                if(ea.type != eb.type) return ea.type < eb.type;
+                break;
+
+            case SYMBOLCOLUMN_VALUE:
+                if(ea.key != eb.key) return ea.key < eb.key;
+                break;
+
+            default: break;
+        }
+
+        return ea.address < eb.address;
+    };
+
+    std::iota(m_order.begin(), m_order.end(), 0);
+    m_sorted = true;
+
+    if(descending)
+        std::ranges::sort(m_order, [&](u32 a, u32 b) { return cmp(b, a); });
+    else
+        std::ranges::sort(m_order, cmp);
+
+    this->update_view();
+}
+
+void SymbolView::filter(std::string_view query) {
+    m_filtered = !query.empty();
+    m_ranked.clear();
+
+    if(!m_filtered)
+        std::ranges::fill(m_filter, ~u64{0});
+    else {
+        std::ranges::fill(m_filter, 0);
+
+        // Entry ids match the table's indices
+        for(const SymbolIndex::Result& r :
+            m_table->index().find(query, SEARCH_NAMES | SEARCH_STRINGS)) {
+            m_filter[r.entry / 64] |= u64{1} << (r.entry % 64);
+            m_ranked.push_back(r.entry);
+        }
+    }
+
+    this->update_view();
+}
+
+void SymbolView::update_view() {
+    // Matches are ranked until a column is sorted
+    if(m_filtered && !m_sorted) {
+        m_view = m_ranked;
+        return;
+    }
+
+    m_view.clear();
+
+    for(u32 idx : m_order) {
+        if(this->is_visible(idx)) m_view.push_back(idx);
+    }
+}
+
+} // namespace redasm
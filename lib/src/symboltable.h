@@ -0,0 +1,76 @@
+#pragma once
+
+#include "symbolindex.h"
+#include <memory>
+#include <mutex>
+#include <redasm/listing.h>
+#include <redasm/types.h>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace redasm {
+
+// Immutable snapshot of a symbol list (symbols, imports or exports),
+// built once per symbol generation with interned values
+class SymbolTable {
+public:
+    struct Entry {
+        RDAddress address;
+        usize type;
+        RDThemeKind theme;
+        const char* value;   // Interned
+        std::string_view key; // Lowercase 'value', interned
+    };
+
+public:
+    SymbolTable(usize kind, usize generation);
+    [[nodiscard]] usize kind() const { return m_kind; }
+    [[nodiscard]] usize generation() const { return m_generation; }
+    [[nodiscard]] usize size() const { return m_entries.size(); }
+    [[nodiscard]] const Entry& at(usize idx) const { return m_entries[idx]; }
+
+    // Search index over the entries, built on first use
+    [[nodiscard]] const SymbolIndex& index() const;
+
+private:
+    std::string_view intern(std::string s);
+
+private:
+    std::vector<Entry> m_entries;
+    std::unordered_set<std::string> m_strings;
+    mutable SymbolIndex m_index;
+    mutable std::once_flag m_indexonce;
+    usize m_kind, m_generation;
+};
+
+// Sorted and filtered view over a snapshot, the snapshot is never touched
+// so sort() and filter() can run outside the UI thread
+class SymbolView {
+public:
+    explicit SymbolView(std::shared_ptr<const SymbolTable> t);
+    [[nodiscard]] const SymbolTable& table() const { return *m_table; }
+    [[nodiscard]] usize size() const { return m_view.size(); }
+    [[nodiscard]] bool is_valid() const;
+    const SymbolTable::Entry* at(usize idx) const;
+    void sort(usize column, bool descending);
+    void filter(std::string_view query);
+
+private:
+    [[nodiscard]] bool is_visible(u32 idx) const {
+        return m_filter[idx / 64] & (u64{1} << (idx % 64));
+    }
+
+    void update_view();
+
+private:
+    std::shared_ptr<const SymbolTable> m_table;
+    std::vector<u32> m_order; // Sort permutation
+    std::vector<u64> m_filter; // Visible entries bitset
+    std::vector<u32> m_ranked; // Filter matches, best first
+    std::vector<u32> m_view;  // 'm_order' without filtered entries
+    bool m_filtered{false}, m_sorted{false};
+};
+
+} // namespace redasm
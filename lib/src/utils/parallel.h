@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <redasm/types.h>
+#include <thread>
+#include <vector>
+
+namespace redasm::utils {
+
+// Upper bound for worker threads, 0 uses every hardware thread
+inline std::atomic<usize> max_threads{0};
+
+inline usize thread_count(usize n) {
+    usize hw = std::max<usize>(std::thread::hardware_concurrency(), 1);
+    if(usize m = utils::max_threads; m > 0) hw = std::min(hw, m);
+    return std::min(n, hw);
+}
+
+// Runs 'f(i)' for i in [0, n), work items are claimed dynamically
+template<typename Function>
+void parallel_for(usize n, Function f) {
+    usize nthreads = utils::thread_count(n);
+
+    if(nthreads <= 1) {
+        for(usize i = 0; i < n; i++)
+            f(i);
+        return;
+    }
+
+    std::atomic<usize> next{0};
+    std::vector<std::thread> workers;
+    workers.reserve(nthreads);
+
+    for(usize t = 0; t < nthreads; t++) {
+        workers.emplace_back([&]() {
+            for(usize i; (i = next.fetch_add(1)) < n;)
+                f(i);
+        });
+    }
+
+    for(std::thread& w : workers)
+        w.join();
+}
+
+} // namespace redasm::utils
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <charconv>
 #include <climits>
 #include <redasm/types.h>
@@ -25,11 +27,15 @@ usize count_bits(i64 n);
 char* copy_str(std::string_view v);
 std::string_view trim(std::string_view v);
 
-template<typename Ret = std::string_view, typename T>
-Ret to_string(T val, int base = 10, bool sign = false, int bits = 0) {
+inline constexpr usize INT_CHARS = 67; // 66+1 for negative sign
+
+// Writes 'val' to 'out' (at least INT_CHARS bytes, not terminated) and
+// returns the number of characters
+template<typename T>
+usize to_chars(char* out, T val, int base = 10, bool sign = false,
+               int bits = 0) {
     using UT = std::make_unsigned_t<T>;
     constexpr std::string_view DIGITS = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    static std::array<char, 67> out; // 66+1 for negative sign
 
     if(base < 2 || base > 36) ct_exceptf("tostring: invalid base %d", base);
 
@@ -43,29 +49,30 @@ Ret to_string(T val, int base = 10, bool sign = false, int bits = 0) {
     else
         uval = val;
 
-    int c = out.size() - 1;
-    out[c] = 0;
+    usize n = 0;
 
     do {
-        T rem = uval % base;
+        out[n++] = DIGITS[uval % base];
         uval /= base;
-        out[--c] = DIGITS.at(rem);
     } while(uval > 0);
 
     if(bits > 0) { // Zero pad
-        int w = bits / 4;
-        if(int ndigits = out.size() - c - 1; w > ndigits) {
-            int nzeros = w - ndigits;
-            for(int i = c - 1; i >= c - nzeros && i >= 0; --i)
-                out[i] = '0';
-
-            c -= nzeros;
-        }
+        usize w = bits / 4;
+        while(n < w && n < INT_CHARS - 2)
+            out[n++] = '0';
     }
 
-    if(isneg) out[--c] = '-';
+    if(isneg) out[n++] = '-';
+    std::reverse(out, out + n);
+    return n;
+}
 
-    return Ret{&out[c], out.size() - c - 1};
+template<typename Ret = std::string_view, typename T>
+Ret to_string(T val, int base = 10, bool sign = false, int bits = 0) {
+    static std::array<char, INT_CHARS> out;
+    usize n = utils::to_chars(out.data(), val, base, sign, bits);
+    out[n] = 0;
+    return Ret{out.data(), n};
 }
 
 template<typename Ret = std::string_view, typename T>
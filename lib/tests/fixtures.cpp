@@ -0,0 +1,199 @@
+#include "fixtures.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fixtures {
+
+namespace {
+
+class Writer {
+public:
+    template<typename T>
+    void put(usize offset, T v) {
+        if(m_data.size() < offset + sizeof(T))
+            m_data.resize(offset + sizeof(T), '\0');
+
+        std::memcpy(m_data.data() + offset, &v, sizeof(T));
+    }
+
+    void put(usize offset, const std::string& s) {
+        if(m_data.size() < offset + s.size())
+            m_data.resize(offset + s.size(), '\0');
+
+        std::memcpy(m_data.data() + offset, s.data(), s.size());
+    }
+
+    std::string save(const std::string& filename) const {
+        std::string fp =
+            (std::filesystem::temp_directory_path() / filename).string();
+
+        std::ofstream ofs{fp, std::ios::binary | std::ios::trunc};
+        ofs.write(m_data.data(), m_data.size());
+        return fp;
+    }
+
+private:
+    std::string m_data;
+};
+
+// Section 'i' is loaded at 'base' + i * SECTION_SIZE
+std::string make_code(u32 base, usize i, usize nsections, usize nfunctions) {
+    std::string code(SECTION_SIZE, '\0');
+    u32 address = base + (i * SECTION_SIZE);
+
+    for(usize j = 0; j < nfunctions; j++) {
+        u32 next = 0;
+
+        if(j + 1 < nfunctions)
+            next = address + FUNCTION_SIZE;
+        else if(i + 1 < nsections)
+            next = base + ((i + 1) * SECTION_SIZE);
+
+        char* p = code.data() + (j * FUNCTION_SIZE);
+        p[0] = '\x55'; // push ebp
+        p[1] = '\x89'; // mov ebp, esp
+        p[2] = '\xe5';
+
+        if(next) {
+            p[3] = '\xe8'; // call next
+            i32 rel = static_cast<i32>(next - (address + 8));
+            std::memcpy(p + 4, &rel, sizeof(rel));
+        }
+        else
+            std::memset(p + 3, '\x90', 5); // nop
+
+        p[8] = '\x5d'; // pop ebp
+        p[9] = '\xc3'; // ret
+        address += FUNCTION_SIZE;
+    }
+
+    return code;
+}
+
+} // namespace
+
+std::string make_elf(const std::string& filename, usize nsections,
+                     usize nfunctions) {
+    constexpr u32 BASE = ELF_BASE;
+    constexpr usize EHDR_SIZE = 52;
+    constexpr usize SHDR_SIZE = 40;
+
+    Writer w;
+    std::string shstrtab{'\0'};
+    std::vector<u32> names;
+
+    for(usize i = 0; i < nsections; i++) {
+        names.push_back(shstrtab.size());
+        shstrtab += ".text" + std::to_string(i);
+        shstrtab.push_back('\0');
+        w.put((i + 1) * SECTION_SIZE,
+              make_code(BASE, i, nsections, nfunctions));
+    }
+
+    u32 shstroff = (nsections + 1) * SECTION_SIZE;
+    u32 shoff = shstroff + shstrtab.size();
+    w.put(shstroff, shstrtab);
+
+    // Null section, code sections, .shstrtab
+    u16 shnum = nsections + 2;
+
+    w.put(0, std::string{"\x7f" "ELF", 4});
+    w.put<u8>(4, 1); // ELFCLASS32
+    w.put<u8>(5, 1); // ELFDATA2LSB
+    w.put<u8>(6, 1); // EV_CURRENT
+    w.put<u16>(16, 2);  // ET_EXEC
+    w.put<u16>(18, 3);  // EM_386
+    w.put<u32>(20, 1);  // EV_CURRENT
+    w.put<u32>(24, BASE);
+    w.put<u32>(32, shoff);
+    w.put<u16>(40, EHDR_SIZE);
+    w.put<u16>(46, SHDR_SIZE);
+    w.put<u16>(48, shnum);
+    w.put<u16>(50, shnum - 1);
+
+    for(usize i = 0; i < nsections; i++) {
+        usize off = shoff + ((i + 1) * SHDR_SIZE);
+        w.put<u32>(off, names[i]);
+        w.put<u32>(off + 4, 1);   // SHT_PROGBITS
+        w.put<u32>(off + 8, 0x6); // SHF_ALLOC | SHF_EXECINSTR
+        w.put<u32>(off + 12, BASE + (i * SECTION_SIZE));
+        w.put<u32>(off + 16, (i + 1) * SECTION_SIZE);
+        w.put<u32>(off + 20, SECTION_SIZE);
+        w.put<u32>(off + 32, 16);
+    }
+
+    usize off = shoff + ((nsections + 1) * SHDR_SIZE);
+    w.put<u32>(off, 0);
+    w.put<u32>(off + 4, 3); // SHT_STRTAB
+    w.put<u32>(off + 16, shstroff);
+    w.put<u32>(off + 20, shstrtab.size());
+    w.put<u32>(off + 32, 1);
+    w.put<u32>(off + 36, 0);
+    return w.save(filename);
+}
+
+std::string make_pe(const std::string& filename, usize nsections,
+                    usize nfunctions) {
+    constexpr u32 IMAGE_BASE = 0x00400000;
+    constexpr u32 FILE_ALIGN = 0x200;
+    constexpr usize NT_OFFSET = 0x40;
+    constexpr usize OPT_OFFSET = NT_OFFSET + 24;
+    constexpr usize SECT_OFFSET = OPT_OFFSET + 0xe0;
+
+    // Headers must fit before the first section (RVA SECTION_SIZE)
+    u32 headerssize = (SECT_OFFSET + (nsections * 40) + FILE_ALIGN - 1) &
+                      ~(FILE_ALIGN - 1);
+    if(headerssize > SECTION_SIZE) return {};
+
+    Writer w;
+    w.put(0, std::string{"MZ"});
+    w.put<u32>(0x3c, NT_OFFSET);
+
+    w.put(NT_OFFSET, std::string{"PE\0\0", 4});
+    w.put<u16>(NT_OFFSET + 4, 0x14c); // IMAGE_FILE_MACHINE_I386
+    w.put<u16>(NT_OFFSET + 6, nsections);
+    w.put<u16>(NT_OFFSET + 20, 0xe0);  // SizeOfOptionalHeader
+    w.put<u16>(NT_OFFSET + 22, 0x102); // EXECUTABLE_IMAGE | 32BIT_MACHINE
+
+    u32 codesize = nsections * SECTION_SIZE;
+
+    w.put<u16>(OPT_OFFSET, 0x10b); // PE32
+    w.put<u32>(OPT_OFFSET + 4, codesize);
+    w.put<u32>(OPT_OFFSET + 16, SECTION_SIZE); // AddressOfEntryPoint
+    w.put<u32>(OPT_OFFSET + 20, SECTION_SIZE); // BaseOfCode
+    w.put<u32>(OPT_OFFSET + 28, IMAGE_BASE);
+    w.put<u32>(OPT_OFFSET + 32, SECTION_SIZE); // SectionAlignment
+    w.put<u32>(OPT_OFFSET + 36, FILE_ALIGN);
+    w.put<u16>(OPT_OFFSET + 40, 4); // MajorOperatingSystemVersion
+    w.put<u16>(OPT_OFFSET + 48, 4); // MajorSubsystemVersion
+    w.put<u32>(OPT_OFFSET + 56, codesize + SECTION_SIZE); // SizeOfImage
+    w.put<u32>(OPT_OFFSET + 60, headerssize);
+    w.put<u16>(OPT_OFFSET + 68, 3); // IMAGE_SUBSYSTEM_WINDOWS_CUI
+    w.put<u32>(OPT_OFFSET + 72, 0x100000); // SizeOfStackReserve
+    w.put<u32>(OPT_OFFSET + 76, 0x1000);   // SizeOfStackCommit
+    w.put<u32>(OPT_OFFSET + 80, 0x100000); // SizeOfHeapReserve
+    w.put<u32>(OPT_OFFSET + 84, 0x1000);   // SizeOfHeapCommit
+    w.put<u32>(OPT_OFFSET + 92, 16);       // NumberOfRvaAndSizes
+
+    for(usize i = 0; i < nsections; i++) {
+        usize off = SECT_OFFSET + (i * 40);
+        u32 rva = (i + 1) * SECTION_SIZE;
+        u32 rawoffset = headerssize + (i * SECTION_SIZE);
+
+        w.put(off, ".t" + std::to_string(i));
+        w.put<u32>(off + 8, SECTION_SIZE); // VirtualSize
+        w.put<u32>(off + 12, rva);
+        w.put<u32>(off + 16, SECTION_SIZE); // SizeOfRawData
+        w.put<u32>(off + 20, rawoffset);
+        w.put<u32>(off + 36, 0x60000020); // CODE | EXECUTE | READ
+
+        w.put(rawoffset, make_code(IMAGE_BASE + SECTION_SIZE, i, nsections,
+                                   nfunctions));
+    }
+
+    return w.save(filename);
+}
+
+} // namespace fixtures
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <redasm/types.h>
+#include <string>
+
+namespace fixtures {
+
+// Generated x86_32 executables: every section holds 'nfunctions' chained
+// functions (push ebp / call next / ret) followed by a zero filled tail,
+// the last function of a section calls the first one of the next section
+constexpr u32 ELF_BASE = 0x08049000;
+constexpr usize SECTION_SIZE = 0x1000;
+constexpr usize FUNCTION_SIZE = 10;
+
+std::string make_elf(const std::string& filename, usize nsections,
+                     usize nfunctions);
+std::string make_pe(const std::string& filename, usize nsections,
+                    usize nfunctions);
+
+} // namespace fixtures
@@ -1,4 +1,12 @@
+#include "fixtures.h"
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string_view>
+#include <vector>
 #include <catch2/catch_session.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <redasm/redasm.h>
@@ -7,10 +15,10 @@
 int main(int argc, char** argv) {
     rd_setloglevel(LOGLEVEL_TRACE);
 
-    rd_addsearchpath("/home/davide/Dev/Progetti/Research/REDasmTech/"
-                     "build_REDasmLib_Debug/plugins/src");
+    rd_addsearchpath(REDASM_TEST_PLUGINS);
+    rd_addsearchpath(REDASM_TEST_CFG); // Python loaders (PE)
 
-    if(rd_init()) {
+    if(rd_init(nullptr)) {
         int result = Catch::Session().run(argc, argv);
 
         rd_deinit();
@@ -20,6 +28,65 @@ int main(int argc, char** argv) {
     return 1;
 }
 
+namespace {
+
+// Many-section inputs, generated in the temp directory
+constexpr usize SAMPLE_SECTIONS = 64;
+constexpr usize SAMPLE_FUNCTIONS = 32;
+
+// Every operator new call of the process, library included
+std::atomic<usize> g_allocations{0};
+
+void select(const std::string& filepath, std::string_view loaderid) {
+    REQUIRE_FALSE(filepath.empty());
+
+    RDBuffer* buffer = rdbuffer_createfile(filepath.c_str());
+    REQUIRE(buffer);
+
+    const RDTestResultSlice* results = rd_test(buffer);
+    REQUIRE(results);
+
+    const RDTestResult* tr = nullptr;
+
+    for(isize i = 0; !tr && i < results->length; i++) {
+        if(slice_at(results, i).loaderplugin->id == loaderid)
+            tr = &slice_at(results, i);
+    }
+
+    REQUIRE(tr);
+    REQUIRE(rd_select(tr));
+}
+
+void disassemble(const std::string& filepath, std::string_view loaderid) {
+    select(filepath, loaderid);
+    rd_disassemble();
+}
+
+const std::string& elf_sample() {
+    static const std::string FILEPATH = fixtures::make_elf(
+        "redasm_sample.elf", SAMPLE_SECTIONS, SAMPLE_FUNCTIONS);
+    return FILEPATH;
+}
+
+const std::string& pe_sample() {
+    static const std::string FILEPATH = fixtures::make_pe(
+        "redasm_sample.exe", SAMPLE_SECTIONS, SAMPLE_FUNCTIONS);
+    return FILEPATH;
+}
+
+void disassemble_sample() { disassemble(elf_sample(), "elf32"); }
+
+} // namespace
+
+void* operator new(std::size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(n ? n : 1); p) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
 TEST_CASE("Type System") {
     // RDHandle hfile = rd_loadfile("/home/davide/Dev/Cavia.exe");
     RDBuffer* buffer =
@@ -102,3 +169,278 @@ TEST_CASE("Type System") {
     val = rd_sizeof("Rect[2]");
     REQUIRE(val == (sizeof(u32) * 4) * 2);
 }
+
+TEST_CASE("Layered Layout Scaling") {
+    constexpr std::array<usize, 3> PATTERNS = {
+        GRAPHPATTERN_NESTED,
+        GRAPHPATTERN_SWITCH,
+        GRAPHPATTERN_IRREDUCIBLE,
+    };
+
+    constexpr std::array<usize, 3> SIZES = {10, 100, 1000};
+
+    RDGraph* g = rdgraph_create();
+
+    for(usize pattern : PATTERNS) {
+        for(usize n : SIZES) {
+            REQUIRE(rdgraph_generate(g, pattern, n));
+
+            const RDGraphNode* nodes = nullptr;
+            usize nc = rdgraph_getnodes(g, &nodes);
+
+            for(usize i = 0; i < nc; i++) {
+                rdgraph_setwidth(g, nodes[i], 120);
+                rdgraph_setheight(g, nodes[i], 40);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            REQUIRE(rdgraphlayout_layered(g, LAYEREDLAYOUT_MEDIUM));
+
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            spdlog::info("Layout: pattern {}, {} blocks, {} ms", pattern, nc,
+                         ms.count());
+        }
+    }
+
+    rdgraph_destroy(g);
+}
+
+TEST_CASE("Listing Build") {
+    constexpr usize RUNS = 10;
+
+    // Thread limits: serial, then every hardware thread
+    constexpr std::array<usize, 2> THREADS = {1, 0};
+
+    const std::array<std::pair<std::string, std::string_view>, 2> SAMPLES = {
+        std::pair{elf_sample(), std::string_view{"elf32"}},
+        std::pair{pe_sample(), std::string_view{"pe"}},
+    };
+
+    for(const auto& [filepath, loaderid] : SAMPLES) {
+        disassemble(filepath, loaderid);
+
+        for(usize nthreads : THREADS) {
+            rd_setmaxthreads(nthreads);
+
+            // Every tick after the analysis rebuilds the listing
+            auto start = std::chrono::steady_clock::now();
+
+            for(usize i = 0; i < RUNS; i++)
+                REQUIRE_FALSE(rd_tick(nullptr));
+
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            REQUIRE(rdlisting_getlength() > 0);
+            spdlog::info("Listing: {}, {} threads, {} rows, {} ms per build",
+                         loaderid, nthreads ? "1" : "all",
+                         rdlisting_getlength(), ms.count() / RUNS);
+        }
+    }
+
+    rd_setmaxthreads(0);
+}
+
+TEST_CASE("Surface Rendering") {
+    constexpr usize RUNS = 100;
+    constexpr usize ROWS = 100;
+    disassemble_sample();
+
+    RDSurface* s = rdsurface_create(SURFACE_DEFAULT);
+    REQUIRE(s);
+
+    usize n = rdlisting_getlength();
+    REQUIRE(n > 0);
+
+    // Scrolling: every frame renders a different window
+    auto start = std::chrono::steady_clock::now();
+
+    for(usize i = 0; i < RUNS; i++) {
+        rdsurface_seek(s, (n / RUNS) * i);
+        rdsurface_render(s, ROWS);
+        REQUIRE(rdsurface_getrowcount(s) > 0);
+    }
+
+    auto scrollus = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    // Repainting: the same window, like cursor moves and timers do
+    rdsurface_seek(s, n / 2);
+    start = std::chrono::steady_clock::now();
+
+    for(usize i = 0; i < RUNS; i++) {
+        rdsurface_render(s, ROWS);
+        rdsurface_getpath(s, nullptr);
+        REQUIRE(rdsurface_getrowcount(s) > 0);
+    }
+
+    auto repaintus = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    spdlog::info("Surface: {} rows, {} us per scroll, {} us per repaint",
+                 ROWS, scrollus.count() / RUNS, repaintus.count() / RUNS);
+
+    rdsurface_destroy(s);
+}
+
+TEST_CASE("Surface Allocations") {
+    constexpr usize RUNS = 100;
+    constexpr usize ROWS = 100;
+    constexpr usize WARMUP = 3; // Row storage and scratch buffers settle
+    disassemble_sample();
+
+    RDSurface* s = rdsurface_create(SURFACE_DEFAULT);
+    REQUIRE(s);
+
+    usize n = rdlisting_getlength();
+    REQUIRE(n > 0);
+    rdsurface_seek(s, n / 2);
+
+    // API calls are traced, log messages must not be counted
+    rd_setloglevel(LOGLEVEL_INFO);
+
+    for(usize i = 0; i < WARMUP; i++) {
+        rdsurface_render(s, ROWS);
+        rdsurface_getpath(s, nullptr);
+    }
+
+    usize allocations = g_allocations.load();
+
+    for(usize i = 0; i < RUNS; i++) {
+        rdsurface_render(s, ROWS);
+        rdsurface_getpath(s, nullptr);
+    }
+
+    allocations = g_allocations.load() - allocations;
+    rd_setloglevel(LOGLEVEL_TRACE);
+
+    spdlog::info("Surface: {} allocations in {} repaints", allocations, RUNS);
+    REQUIRE(rdsurface_getrowcount(s) > 0);
+    REQUIRE(allocations < RUNS / 10); // Near zero, never one per frame
+
+    rdsurface_destroy(s);
+}
+
+TEST_CASE("Listing Export") {
+    constexpr std::array<usize, 3> FLAGS = {0, EXPORT_JSONL, EXPORT_RDIL};
+    disassemble_sample();
+
+    std::string fp =
+        (std::filesystem::temp_directory_path() / "redasm_export.lst")
+            .string();
+
+    for(usize flags : FLAGS) {
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(rd_exportlisting(fp.c_str(), flags));
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        spdlog::info("Export: flags {}, {} bytes, {} ms", flags,
+                     std::filesystem::file_size(fp), ms.count());
+    }
+
+    std::filesystem::remove(fp);
+}
+
+TEST_CASE("Snapshot Round Trip") {
+    constexpr std::array<usize, 2> FLAGS = {0, SNAP_COMPRESS};
+    constexpr RDAddress ENTRY = fixtures::ELF_BASE;
+    constexpr RDAddress CALLER = ENTRY + 3;
+    constexpr RDAddress LAST = ENTRY + fixtures::SECTION_SIZE - 0x10;
+    constexpr int SREG = 1;
+
+    struct State {
+        std::vector<std::string> segments;
+        std::vector<std::string> names;
+        std::vector<RDRef> refs;
+        RDRegValue sreg;
+        std::vector<RDBasicBlock> blocks;
+    };
+
+    auto capture = []() {
+        State s;
+
+        const RDSegmentSlice* segments = rd_getsegments();
+        for(isize i = 0; i < segments->length; i++) {
+            const RDSegment& seg = slice_at(segments, i);
+            s.segments.push_back(fmt::format("{}:{:x}-{:x}", seg.name,
+                                             seg.start, seg.end));
+        }
+
+        const RDRef* refs = nullptr;
+        usize n = rd_getrefsfrom(CALLER, &refs);
+        s.refs.assign(refs, refs + n);
+        s.sreg = rd_getsreg(LAST, SREG);
+
+        for(usize i = 0; i < SAMPLE_SECTIONS; i++) {
+            for(usize j = 0; j < SAMPLE_FUNCTIONS; j++) {
+                RDAddress address = ENTRY + (i * fixtures::SECTION_SIZE) +
+                                    (j * fixtures::FUNCTION_SIZE);
+
+                const char* name = rd_getname(address);
+                s.names.emplace_back(name ? name : "");
+
+                RDFunction* f = rd_findfunction(address);
+                if(!f) continue;
+
+                const RDGraphNode* nodes = nullptr;
+                usize nc = rdgraph_getnodes(rdfunction_getgraph(f), &nodes);
+
+                for(usize k = 0; k < nc; k++)
+                    s.blocks.push_back(*rdfunction_getbasicblock(f, nodes[k]));
+            }
+        }
+
+        return s;
+    };
+
+    auto check = [](const State& a, const State& b) {
+        REQUIRE(a.segments == b.segments);
+        REQUIRE(a.names == b.names);
+        REQUIRE(a.refs.size() == b.refs.size());
+
+        for(usize i = 0; i < a.refs.size(); i++) {
+            REQUIRE(a.refs[i].address == b.refs[i].address);
+            REQUIRE(a.refs[i].type == b.refs[i].type);
+        }
+
+        REQUIRE(a.sreg.ok == b.sreg.ok);
+        REQUIRE(a.sreg.value == b.sreg.value);
+        REQUIRE(a.blocks.size() == b.blocks.size());
+
+        for(usize i = 0; i < a.blocks.size(); i++) {
+            REQUIRE(a.blocks[i].start == b.blocks[i].start);
+            REQUIRE(a.blocks[i].end == b.blocks[i].end);
+        }
+    };
+
+    std::string fp =
+        (std::filesystem::temp_directory_path() / "redasm_snapshot.rds")
+            .string();
+
+    for(usize flags : FLAGS) {
+        disassemble_sample();
+        REQUIRE(rd_setname(ENTRY, "snapshot_entry"));
+        rd_addsreg_range(ENTRY, LAST + 1, SREG, 0x1234);
+
+        State saved = capture();
+        REQUIRE_FALSE(saved.refs.empty());
+        REQUIRE_FALSE(saved.blocks.empty());
+        REQUIRE(saved.sreg.ok);
+        REQUIRE(rd_savesnapshot(fp.c_str(), flags));
+
+        // Restore into a loaded, but not analyzed, context
+        select(elf_sample(), "elf32");
+        REQUIRE(rd_loadsnapshot(fp.c_str()));
+        check(saved, capture());
+
+        // Ticks after the load keep the restored functions
+        REQUIRE_FALSE(rd_tick(nullptr));
+        check(saved, capture());
+    }
+
+    std::filesystem::remove(fp);
+}
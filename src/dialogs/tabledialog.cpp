@@ -1,4 +1,5 @@
 #include "tabledialog.h"
+#include "../models/symbolsfiltermodel.h"
 #include <QSortFilterProxyModel>
 
 TableDialog::TableDialog(QWidget* parent): QDialog{parent}, m_ui{this} {
@@ -14,7 +15,11 @@ TableDialog::TableDialog(QWidget* parent): QDialog{parent}, m_ui{this} {
             [=](const QString& s) {
                 auto* sfmodel =
                     static_cast<QSortFilterProxyModel*>(m_ui.tvtable->model());
-                sfmodel->setFilterFixedString(s);
+
+                if(auto* m = qobject_cast<SymbolsFilterModel*>(sfmodel); m)
+                    m->set_filter(s);
+                else
+                    sfmodel->setFilterFixedString(s);
             });
 }
 
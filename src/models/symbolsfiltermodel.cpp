@@ -1,10 +1,8 @@
 #include "symbolsfiltermodel.h"
-#include <QRegularExpression>
 
 SymbolsFilterModel::SymbolsFilterModel(bool autoalign, QObject* parent)
     : QSortFilterProxyModel{parent} {
     this->setSourceModel(new SymbolsModel(autoalign, this));
-    this->setFilterKeyColumn(2);
 }
 
 SymbolsFilterModel::SymbolsFilterModel(usize filter, bool autoalign,
@@ -17,6 +15,11 @@ RDAddress SymbolsFilterModel::address(const QModelIndex& index) const {
     return this->symbols_model()->address(this->mapToSource(index));
 }
 
+void SymbolsFilterModel::sort(int column, Qt::SortOrder order) {
+    // Sorted by the symbol table, the proxy keeps the source order
+    this->symbols_model()->sort(column, order);
+}
+
 void SymbolsFilterModel::resync() {
     this->symbols_model()->resync();
     this->invalidate();
@@ -24,14 +27,9 @@ void SymbolsFilterModel::resync() {
 
 bool SymbolsFilterModel::filterAcceptsRow(int source_row,
                                           const QModelIndex&) const {
-    QModelIndex index = this->sourceModel()->index(source_row, 2);
-    QString s = index.data().toString();
+    // Text is filtered by the symbol table, see set_filter()
+    if(m_typefilter == SYMBOL_INVALID) return true;
 
-    if(!s.contains(this->filterRegularExpression()))
-        return false;
-
-    if(m_typefilter != SYMBOL_INVALID)
-        return m_typefilter == index.data(Qt::UserRole).toUInt();
-
-    return true;
+    QModelIndex index = this->sourceModel()->index(source_row, 2);
+    return m_typefilter == index.data(Qt::UserRole).toUInt();
 }
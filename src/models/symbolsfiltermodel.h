@@ -15,7 +15,9 @@ public:
     explicit SymbolsFilterModel(usize filter, bool autoalign = true,
                                 QObject* parent = nullptr);
     [[nodiscard]] RDAddress address(const QModelIndex& index) const;
+    void set_filter(const QString& s) { this->symbols_model()->set_filter(s); }
     void resync();
+    void sort(int column, Qt::SortOrder order) override;
 
     void set_type_filter(usize s) {
         m_typefilter = s;
@@ -1,6 +1,7 @@
 #include "symbolsmodel.h"
 #include "../themeprovider.h"
 #include "../utils.h"
+#include <QtConcurrentRun>
 
 namespace {
 
@@ -25,26 +26,84 @@ QString mangled_string(const char* s) {
 
 SymbolsModel::SymbolsModel(bool autoalign, QObject* parent)
     : QAbstractListModel{parent}, m_autoalign{autoalign} {
-    m_nsymbols = rdlisting_getsymbolslength();
+    m_symbols = rdsymboltable_create(SYMBOLTABLE_SYMBOLS);
     m_colsymbol = tr("Symbol");
 }
 
+SymbolsModel::~SymbolsModel() {
+    // Views being sorted or filtered are still owned by their futures
+    for(ViewWatcher* w : m_pending) {
+        w->waitForFinished();
+        rdsymboltable_destroy(w->result());
+    }
+
+    rdsymboltable_destroy(m_symbols);
+}
+
 RDAddress SymbolsModel::address(const QModelIndex& index) const {
     RDSymbol symbol;
-    if(rdlisting_getsymbol(index.row(), &symbol)) return symbol.address;
+    if(rdsymboltable_get(m_symbols, index.row(), &symbol))
+        return symbol.address;
+
     qFatal("Cannot get symbol address");
     return {};
 }
 
+void SymbolsModel::set_filter(const QString& s) {
+    if(s == m_filter) return;
+
+    m_filter = s;
+    this->update_view();
+}
+
 void SymbolsModel::resync() {
-    this->beginResetModel();
-    m_nsymbols = rdlisting_getsymbolslength();
-    this->endResetModel();
+    if(rdsymboltable_isvalid(m_symbols)) return; // Same snapshot
+    if(m_next && rdsymboltable_isvalid(m_next)) return; // Already requested
+    this->update_view();
+}
+
+// The view is rebuilt from the current snapshot and sorted/filtered outside
+// the UI thread, the old one is shown until the new one is swapped in
+void SymbolsModel::update_view() {
+    RDSymbolTable* v = rdsymboltable_create(SYMBOLTABLE_SYMBOLS);
+    if(!v) return;
+
+    int column = m_sortcolumn;
+    bool descending = m_sortorder == Qt::DescendingOrder;
+    QByteArray filter = m_filter.toUtf8();
+    usize serial = ++m_serial;
+
+    auto* watcher = new ViewWatcher(this);
+    m_pending.push_back(watcher);
+    m_next = v;
+
+    connect(watcher, &ViewWatcher::finished, this, [this, watcher, serial]() {
+        RDSymbolTable* res = watcher->result();
+        m_pending.removeOne(watcher);
+        watcher->deleteLater();
+
+        if(serial != m_serial) { // Superseded by a newer request
+            rdsymboltable_destroy(res);
+            return;
+        }
+
+        this->beginResetModel();
+        rdsymboltable_destroy(m_symbols);
+        m_symbols = res;
+        m_next = nullptr;
+        this->endResetModel();
+    });
+
+    watcher->setFuture(QtConcurrent::run([v, column, descending, filter]() {
+        if(column != -1) rdsymboltable_sort(v, column, descending);
+        if(!filter.isEmpty()) rdsymboltable_filter(v, filter.constData());
+        return v;
+    }));
 }
 
 QVariant SymbolsModel::data(const QModelIndex& index, int role) const {
     RDSymbol symbol;
-    if(!rdlisting_getsymbol(index.row(), &symbol)) return {};
+    if(!rdsymboltable_get(m_symbols, index.row(), &symbol)) return {};
 
     if(role == Qt::DisplayRole) {
         switch(index.column()) {
@@ -93,7 +152,17 @@ QVariant SymbolsModel::headerData(int section, Qt::Orientation orientation,
 }
 
 int SymbolsModel::columnCount(const QModelIndex&) const { return 3; }
-int SymbolsModel::rowCount(const QModelIndex&) const { return m_nsymbols; }
+int SymbolsModel::rowCount(const QModelIndex&) const {
+    return rdsymboltable_getlength(m_symbols);
+}
+
+void SymbolsModel::sort(int column, Qt::SortOrder order) {
+    if(column < 0) return;
+
+    m_sortcolumn = column;
+    m_sortorder = order;
+    this->update_view();
+}
 
 QString SymbolsModel::get_symbol_type(usize t) const {
     switch(t) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 #include <redasm/redasm.h>
 
 class SymbolsModel: public QAbstractListModel {
@@ -8,10 +9,12 @@ class SymbolsModel: public QAbstractListModel {
 
 public:
     explicit SymbolsModel(bool autoalign = true, QObject* parent = nullptr);
+    ~SymbolsModel() override;
     [[nodiscard]] RDAddress address(const QModelIndex& index) const;
     void set_symbol_column_text(const QString& s) { m_colsymbol = s; }
     void set_highlight_address(bool b) { m_highlightaddress = b; }
     void set_highlight_symbol(bool b) { m_highlightsymbol = b; }
+    void set_filter(const QString& s);
     void resync();
 
 public:
@@ -21,13 +24,22 @@ public:
                                       int role) const override;
     [[nodiscard]] int columnCount(const QModelIndex&) const override;
     [[nodiscard]] int rowCount(const QModelIndex&) const override;
+    void sort(int column, Qt::SortOrder order) override;
 
 private:
+    using ViewWatcher = QFutureWatcher<RDSymbolTable*>;
+
     [[nodiscard]] QString get_symbol_type(usize t) const;
+    void update_view();
 
 private:
-    QString m_colsymbol;
-    usize m_nsymbols;
+    QString m_colsymbol, m_filter;
+    RDSymbolTable* m_symbols;
+    const RDSymbolTable* m_next{nullptr}; // Latest requested view
+    QList<ViewWatcher*> m_pending;
+    usize m_serial{0};
+    int m_sortcolumn{-1};
+    Qt::SortOrder m_sortorder{Qt::AscendingOrder};
     bool m_autoalign;
     bool m_highlightaddress{false}, m_highlightsymbol{false};
 };
@@ -1,5 +1,12 @@
 #include "contextview.h"
 #include "../statusbar.h"
+#include "../utils.h"
+
+namespace {
+
+constexpr usize PRELAYOUT_MIN_BLOCKS = 64;
+
+}
 
 ContextView::ContextView(QWidget* parent): QWidget{parent}, m_ui{this} {
     m_functionsmodel = new SymbolsFilterModel(SYMBOL_FUNCTION, false, this);
@@ -10,6 +17,14 @@ ContextView::ContextView(QWidget* parent): QWidget{parent}, m_ui{this} {
     m_ui.tvfunctions->header()->hideSection(1);
     m_ui.tvfunctions->header()->setSectionResizeMode(2, QHeaderView::Stretch);
 
+    // Pre-layout graphs are measured between events, a few at a time
+    m_prelayouttimer = new QTimer(this);
+    m_prelayouttimer->setInterval(0);
+
+    connect(m_prelayouttimer, &QTimer::timeout, this, [&]() {
+        if(!rd_stepprelayout()) m_prelayouttimer->stop();
+    });
+
     connect(m_ui.tvfunctions, &QTreeView::doubleClicked, this,
             [&](const QModelIndex& index) {
                 RDAddress address = m_functionsmodel->address(index);
@@ -28,5 +43,17 @@ void ContextView::tick(const RDWorkerStatus* s) {
         m_ui.splitview->invalidate();
     }
 
-    if(!s->busy) m_ui.splitview->surface_view()->jump_to_ep();
+    if(!s->busy) {
+        m_ui.splitview->surface_view()->jump_to_ep();
+
+        // Lay out big functions in background (see SurfaceGraphNode::size())
+        RDPreLayoutParams params = {
+            .minblocks = PRELAYOUT_MIN_BLOCKS,
+            .type = LAYEREDLAYOUT_MEDIUM,
+            .cellwidth = utils::cell_width(),
+            .cellheight = utils::cell_height(),
+        };
+
+        if(rd_prelayout(&params)) m_prelayouttimer->start();
+    }
 }
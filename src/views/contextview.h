@@ -2,6 +2,7 @@
 
 #include "../models/symbolsfiltermodel.h"
 #include "../ui/contextview.h"
+#include <QTimer>
 
 class ContextView: public QWidget {
     Q_OBJECT
@@ -29,5 +30,6 @@ public:
 private:
     ui::ContextView m_ui;
     SymbolsFilterModel* m_functionsmodel;
+    QTimer* m_prelayouttimer;
     bool m_active{true};
 };
@@ -40,9 +40,8 @@ int SurfaceGraphNode::current_row() const {
 }
 
 QSize SurfaceGraphNode::size() const {
-    QSize sz = m_document.size().toSize();
-    sz.setWidth(m_maxwidth); // Scale to longest row
-    return sz;
+    // Rows/columns * cell size, like rd_prelayout()
+    return QSize{m_maxwidth, m_maxheight};
 }
 
 void SurfaceGraphNode::mousedoubleclick_event(QMouseEvent*) {
@@ -81,6 +80,7 @@ void SurfaceGraphNode::update_document() {
         usize nmaxcol = utils::draw_surface(m_surface, &m_document, startidx,
                                             endidx - startidx + 1);
         m_maxwidth = nmaxcol * utils::cell_width();
+        m_maxheight = (endidx - startidx + 1) * utils::cell_height();
     }
     else
         m_document.clear();
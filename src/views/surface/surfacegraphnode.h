@@ -33,5 +33,5 @@ private:
     const RDBasicBlock* m_basicblock;
     QTextDocument m_document;
     RDSurface* m_surface;
-    int m_maxwidth{};
+    int m_maxwidth{}, m_maxheight{};
 };
@@ -32,7 +32,7 @@ SurfacePopup::~SurfacePopup() { rdsurface_destroy(m_surface); }
 bool SurfacePopup::popup(RDAddress address) {
     LIndex index;
 
-    if(!rdlisting_getindex(address, &index)) {
+    if(!rdlisting_getcontainingindex(address, &index)) {
         this->hide();
         return false;
     }
@@ -132,7 +132,7 @@ void SurfaceWidget::clear_history() {
 void SurfaceWidget::jump_to(RDAddress address) {
     LIndex index;
 
-    if(rdlisting_getindex(address, &index)) {
+    if(rdlisting_getcontainingindex(address, &index)) {
         if(this->is_index_visible(index)) {
             auto [start, end] = this->get_visible_range();
             rdsurface_setposition(m_surface, index - start, -1);